@@ -50,6 +50,10 @@ void Button::draw(sf::RenderWindow& window) {
     window.draw(text);
 }
 
+void Button::setLabel(const std::wstring& label) {
+    text.setString(label);
+}
+
 void Button::setPosition(sf::Vector2f position) {
     sf::Vector2f offset = position - shape.getPosition();
     shape.move(offset);
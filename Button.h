@@ -20,4 +20,5 @@ public:
     bool isClicked(const sf::Vector2f& mousePos, bool mousePressed);
     void draw(sf::RenderWindow& window);
     void setPosition(sf::Vector2f position);
+    void setLabel(const std::wstring& label);
 }; 
@@ -1,11 +1,14 @@
 #include "NewGame.h"
 #include "Button.h"
 #include "chess_game.h"
+#include "engine_pool.hpp"
+#include "bot_difficulty.hpp"
 #include <SFML/Graphics.hpp>
 #include <SFML/Audio.hpp>
 #include <algorithm>
 
 void openNewGame(sf::RenderWindow& window, float musicVolume, float soundVolume) {
+    EnginePool::instance().warmUp();
 
     sf::Font font;
     if (!font.loadFromFile("image/arial.ttf")) return;
@@ -20,6 +23,8 @@ void openNewGame(sf::RenderWindow& window, float musicVolume, float soundVolume)
 
 
     const int buttonCount = 3;
+    //    :        .
+    const int buttonLevels[buttonCount] = { 0, 10, 20 };
     Button botGameBtns[buttonCount];
     const float buttonWidth = 300.f;
     const float buttonHeight = 60.f;
@@ -48,6 +53,17 @@ void openNewGame(sf::RenderWindow& window, float musicVolume, float soundVolume)
         
     }
 
+    const int timeControlCount = 3;
+    const std::wstring timeControlLabels[timeControlCount] = { L" ", L" 3+2", L" 1+0" };
+    const TimeControl timeControls[timeControlCount] = { { 0, 0 }, { 180000, 2000 }, { 60000, 0 } };
+    int timeControlIndex = 0;
+
+    Button timeControlBtn;
+    timeControlBtn.setup(font, timeControlLabels[timeControlIndex],
+        sf::Vector2f(window.getSize().x / 2 - buttonWidth / 2, startY + buttonCount * (buttonHeight + spacing)),
+        sf::Vector2f(buttonWidth, buttonHeight),
+        &hoverSound, &clickSound);
+
 
     sf::Texture backTexture;
     if (!backTexture.loadFromFile("image/back.png")) return;
@@ -79,6 +95,11 @@ void openNewGame(sf::RenderWindow& window, float musicVolume, float soundVolume)
 
         sf::Vector2f mousePos = window.mapPixelToCoords(sf::Mouse::getPosition(window));
 
+        timeControlBtn.update(mousePos);
+        if (timeControlBtn.isClicked(mousePos, mousePressed)) {
+            timeControlIndex = (timeControlIndex + 1) % timeControlCount;
+            timeControlBtn.setLabel(timeControlLabels[timeControlIndex]);
+        }
 
         for (int i = 0; i < buttonCount; i++) {
             botGameBtns[i].update(mousePos);
@@ -91,20 +112,14 @@ void openNewGame(sf::RenderWindow& window, float musicVolume, float soundVolume)
                 ChessGameSettings settings;
                 settings.soundVolume = soundVolume;
                 settings.musicVolume = musicVolume;
-                settings.engineDepth = 10;
+                BotDifficulty difficulty = botDifficulty(buttonLevels[i]);
+                settings.botLimits = difficulty.limits();
+                settings.timeControl = timeControls[timeControlIndex];
                 settings.moveSound = &moveSound;
-                int levell;
-                if (i == 1) {
-                    levell = 0;
-                }
-                else if (i == 2) {
-                    levell = 10;
-                }
-                else {
-                    levell = 20;
-                }
-
-                int level = i + 1;
+                int levell = difficulty.level;
+                //    :     .
+                settings.speculation = levell == 0 ? 2 : 3;
+
                 runChessGame(window, settings, levell);
                 window.setTitle("Vibe Chess");
             }
@@ -134,6 +149,7 @@ void openNewGame(sf::RenderWindow& window, float musicVolume, float soundVolume)
         for (int i = 0; i < buttonCount; i++) {
             botGameBtns[i].draw(window);
         }
+        timeControlBtn.draw(window);
 
         window.draw(backButton);
         window.display();
@@ -0,0 +1,365 @@
+// bitboard.hpp
+#pragma once
+#include <cstdint>
+#if defined(__x86_64__) || defined(_M_X64)
+#define BITBOARD_PEXT_AVAILABLE
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// One bit per square, a1 = bit 0 .. h8 = bit 63, the same numbering as
+// UciMove. Attack sets for every piece, plus the between/line masks the
+// legal move generator uses for checks and pins. Every table is built by
+// the compiler, so nothing runs at startup; sliders are looked up with
+// PEXT on CPUs that have BMI2 and with magic multiplication elsewhere.
+typedef uint64_t Bitboard;
+
+constexpr Bitboard squareBit(int square) {
+    return 1ull << square;
+}
+
+inline int lowestSquare(Bitboard bits) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanForward64(&index, bits);
+    return static_cast<int>(index);
+#elif defined(_MSC_VER)
+    // 32-bit MSVC only scans 32-bit words: the low half, then the high one.
+    unsigned long index;
+    if (_BitScanForward(&index, static_cast<uint32_t>(bits))) return static_cast<int>(index);
+    _BitScanForward(&index, static_cast<uint32_t>(bits >> 32));
+    return static_cast<int>(index) + 32;
+#else
+    return __builtin_ctzll(bits);
+#endif
+}
+
+inline int popLowestSquare(Bitboard& bits) {
+    int square = lowestSquare(bits);
+    bits &= bits - 1;
+    return square;
+}
+
+inline int countSquares(Bitboard bits) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    return static_cast<int>(__popcnt64(bits));
+#elif defined(_MSC_VER)
+    return static_cast<int>(__popcnt(static_cast<uint32_t>(bits)) + __popcnt(static_cast<uint32_t>(bits >> 32)));
+#else
+    return __builtin_popcountll(bits);
+#endif
+}
+
+constexpr bool moreThanOne(Bitboard bits) {
+    return (bits & (bits - 1)) != 0;
+}
+
+// Rays towards higher squares first, each four after its opposite; the
+// diagonals are the ones with bit 1 set.
+enum RayDirection { RAY_N, RAY_E, RAY_NE, RAY_NW, RAY_S, RAY_W, RAY_SW, RAY_SE, RAY_COUNT };
+
+enum SliderKind { SLIDER_BISHOP, SLIDER_ROOK };
+
+constexpr int RAY_STEPS[RAY_COUNT][2] = { {0, 1}, {1, 0}, {1, 1}, {-1, 1}, {0, -1}, {-1, 0}, {-1, -1}, {1, -1} };
+
+constexpr bool onBoard(int file, int rank) {
+    return file >= 0 && file < 8 && rank >= 0 && rank < 8;
+}
+
+struct BitboardTables {
+    Bitboard knight[64] = {};
+    Bitboard king[64] = {};
+    Bitboard pawn[2][64] = {}; // [0] white, [1] black: squares a pawn there captures on
+    Bitboard rays[RAY_COUNT][64] = {};
+    Bitboard between[64][64] = {}; // strictly between two aligned squares, else 0
+    Bitboard line[64][64] = {};    // the whole line through two aligned squares, else 0
+
+    constexpr BitboardTables() {
+        const int KNIGHT_STEPS[8][2] = { {1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2} };
+
+        for (int square = 0; square < 64; ++square) {
+            int file = square & 7, rank = square >> 3;
+            for (const auto& step : KNIGHT_STEPS) {
+                if (onBoard(file + step[0], rank + step[1])) knight[square] |= squareBit(square + step[1] * 8 + step[0]);
+            }
+            for (int dir = 0; dir < RAY_COUNT; ++dir) {
+                int f = file + RAY_STEPS[dir][0], r = rank + RAY_STEPS[dir][1];
+                if (onBoard(f, r)) king[square] |= squareBit(r * 8 + f);
+                for (; onBoard(f, r); f += RAY_STEPS[dir][0], r += RAY_STEPS[dir][1]) {
+                    rays[dir][square] |= squareBit(r * 8 + f);
+                }
+            }
+            if (rank < 7) {
+                if (file > 0) pawn[0][square] |= squareBit(square + 7);
+                if (file < 7) pawn[0][square] |= squareBit(square + 9);
+            }
+            if (rank > 0) {
+                if (file > 0) pawn[1][square] |= squareBit(square - 9);
+                if (file < 7) pawn[1][square] |= squareBit(square - 7);
+            }
+        }
+
+        for (int a = 0; a < 64; ++a) {
+            for (int dir = 0; dir < RAY_COUNT; ++dir) {
+                int opposite = dir < RAY_S ? dir + RAY_S : dir - RAY_S;
+                for (int b = 0; b < 64; ++b) {
+                    if (!(rays[dir][a] & squareBit(b))) continue;
+                    between[a][b] = rays[dir][a] & rays[opposite][b];
+                    line[a][b] = rays[dir][a] | rays[opposite][a] | squareBit(a);
+                }
+            }
+        }
+    }
+};
+
+inline constexpr BitboardTables BITBOARD_TABLES{};
+
+constexpr Bitboard highestBit(Bitboard bits) {
+    bits |= bits >> 1;
+    bits |= bits >> 2;
+    bits |= bits >> 4;
+    bits |= bits >> 8;
+    bits |= bits >> 16;
+    bits |= bits >> 32;
+    return bits ^ (bits >> 1);
+}
+
+// Squares a slider on `square` reaches along one ray, up to and including
+// the nearest occupied square. Only the table builders use it; it isolates
+// the blocker with bit tricks instead of walking, which keeps the
+// compile-time work within what compilers allow.
+constexpr Bitboard rayAttacks(int dir, int square, Bitboard occupied) {
+    Bitboard ray = BITBOARD_TABLES.rays[dir][square];
+    Bitboard blockers = ray & occupied;
+    if (!blockers) return ray;
+    if (dir < RAY_S) {
+        Bitboard nearest = blockers & (0 - blockers);
+        return ray & (nearest | (nearest - 1));
+    }
+    return ray & ~(highestBit(blockers) - 1);
+}
+
+constexpr bool isDiagonal(int dir) {
+    return (dir & 2) != 0;
+}
+
+// Found offline by random search for the smallest ("fancy") table size,
+// popcount(mask) index bits per square.
+constexpr Bitboard BISHOP_MAGICS[64] = {
+    0x0420220228022c80ull, 0x200208010c108000ull, 0x1004010411040040ull, 0x12a4040292002440ull,
+    0x0804042082000850ull, 0x0802020220010440ull, 0x800401048260201aull, 0x0041010800828800ull,
+    0x4040641488080104ull, 0x20002004016e0020ull, 0x0c2c223a12420042ull, 0x0100024081020220ull,
+    0x0383211041025080ull, 0x08c0030420160600ull, 0x0c1000510808c00aull, 0x40501a0084140280ull,
+    0x40280040112c0088ull, 0x4020040908110050ull, 0x1028001008801412ull, 0x0104220202020000ull,
+    0x800a000400940010ull, 0x0401000200512410ull, 0x1082012100900408ull, 0x0101402208440c00ull,
+    0x00482104c01c1111ull, 0x0310105008017101ull, 0x0022010108080020ull, 0x02300400104010a0ull,
+    0x1401010011444000ull, 0x1001020000405020ull, 0x00010a0804480411ull, 0x0419220010404400ull,
+    0x0010020a00200820ull, 0xa008280909040104ull, 0x0210209010080020ull, 0x3006110800040040ull,
+    0x0800820200440090ull, 0x0008100421810080ull, 0x0028060093264800ull, 0x0a08004088810080ull,
+    0x3611100290442000ull, 0x0241081282001001ull, 0x11081108010d0800ull, 0x002a102014420800ull,
+    0x480002600a004500ull, 0x8001010102000100ull, 0x2008080810410883ull, 0x0002080901101022ull,
+    0x2800942420444080ull, 0x2000840108024000ull, 0x0000804844100040ull, 0x1444120020884540ull,
+    0x0004001002020c00ull, 0x041041c801010049ull, 0x0060045000850810ull, 0x1003240c14820208ull,
+    0x3010104a10100800ull, 0x0280020101580200ull, 0x1000000101081600ull, 0x0644009800420200ull,
+    0x0050040008102402ull, 0x00000004601c8106ull, 0x00088530040812a0ull, 0x800218010102020cull
+};
+
+constexpr Bitboard ROOK_MAGICS[64] = {
+    0x0280132180004001ull, 0x0140001000200040ull, 0x0880200010000880ull, 0x2080080005801000ull,
+    0x0200041020080200ull, 0x0200041041084200ull, 0x0400080081124410ull, 0x2180042100004080ull,
+    0x8000800099644000ull, 0x0802003040820100ull, 0x0105801001862000ull, 0x0101002008100100ull,
+    0x1000800400080080ull, 0x0804800200040080ull, 0x2001800200800900ull, 0x00160004088204c1ull,
+    0x228000c001402000ull, 0x8510004000200050ull, 0x3001848020029000ull, 0x0280808010000801ull,
+    0x0109010010040800ull, 0x8000808004000200ull, 0x8000040081021028ull, 0x40040a0009004884ull,
+    0x80c0004280008035ull, 0x0010004040002000ull, 0x1101200500410070ull, 0x8410100080080080ull,
+    0x000c080080800400ull, 0x4012008080040002ull, 0x4000040101000200ull, 0x0061010200008044ull,
+    0x0080804010800020ull, 0x3000201008400040ull, 0x4112008012002444ull, 0x0848000880801000ull,
+    0x00a8008008800400ull, 0x200200280a00500cull, 0x080a221024004801ull, 0xc400008042000104ull,
+    0x8000400080028022ull, 0x0220008040018020ull, 0x4000200011010040ull, 0x10060040210a0010ull,
+    0x40820020904a0004ull, 0x0030040002008080ull, 0x0200020801840010ull, 0x0084c04100820004ull,
+    0x4802010080c2a600ull, 0x0000400080201880ull, 0x2040801000200080ull, 0x0180200842001200ull,
+    0x0013510008000500ull, 0x0182000c00808a80ull, 0x1000524821302400ull, 0x3800040108488200ull,
+    0x104a004810210082ull, 0x0004210010420082ull, 0xc424110008200241ull, 0x90101000a0088501ull,
+    0x0182000420100802ull, 0x4822001001080402ull, 0x05d0080090012204ull, 0x2008140089042846ull
+};
+
+const int SLIDER_TABLE_SIZE = 5248 + 102400; // bishop, then rook entries
+
+// The part of a ray a blocker can matter on: a piece on its last square
+// changes nothing.
+constexpr Bitboard relevantRay(int dir, int square) {
+    Bitboard ray = BITBOARD_TABLES.rays[dir][square];
+    return ray & ~(dir < RAY_S ? highestBit(ray) : ray & (0 - ray));
+}
+
+// Both lookups share the per-square masks and offsets and differ only in
+// how an occupancy becomes an index. Carry-rippler enumeration visits the
+// subsets of a mask in PEXT order, so the PEXT table is filled in sequence.
+struct SliderTables {
+    Bitboard mask[2][64] = {};
+    unsigned offset[2][64] = {};
+    int shift[2][64] = {};
+    Bitboard magicAttacks[SLIDER_TABLE_SIZE] = {};
+    Bitboard pextAttacks[SLIDER_TABLE_SIZE] = {};
+
+    constexpr SliderTables() {
+        unsigned next = 0;
+        for (int kind = SLIDER_BISHOP; kind <= SLIDER_ROOK; ++kind) {
+            for (int square = 0; square < 64; ++square) {
+                Bitboard relevant = 0;
+                for (int dir = 0; dir < RAY_COUNT; ++dir) {
+                    if (isDiagonal(dir) == (kind == SLIDER_BISHOP)) relevant |= relevantRay(dir, square);
+                }
+                int bits = 0;
+                for (Bitboard rest = relevant; rest; rest &= rest - 1) ++bits;
+                mask[kind][square] = relevant;
+                offset[kind][square] = next;
+                shift[kind][square] = 64 - bits;
+                if (kind == SLIDER_ROOK) fillRook(square, next);
+                else fillBishop(square, next);
+                next += 1u << bits;
+            }
+        }
+    }
+
+private:
+    constexpr void fillBishop(int square, unsigned base) {
+        Bitboard relevant = mask[SLIDER_BISHOP][square];
+        unsigned index = base;
+        Bitboard subset = 0;
+        do {
+            Bitboard attacks = rayAttacks(RAY_NE, square, subset) | rayAttacks(RAY_NW, square, subset) |
+                rayAttacks(RAY_SW, square, subset) | rayAttacks(RAY_SE, square, subset);
+            magicAttacks[base + ((subset * BISHOP_MAGICS[square]) >> shift[SLIDER_BISHOP][square])] = attacks;
+            pextAttacks[index++] = attacks;
+            subset = (subset - relevant) & relevant;
+        } while (subset);
+    }
+
+    // 100k entries are too many to build one subset at a time within the
+    // compilers' constexpr budgets. A rook's rays occupy disjoint bit ranges,
+    // S below W below E below N, so nesting the per-ray subsets with S
+    // innermost reproduces PEXT order while each ray is only solved once.
+    constexpr void fillRook(int square, unsigned base) {
+        const int ORDER[4] = { RAY_S, RAY_W, RAY_E, RAY_N };
+        Bitboard parts[4][64] = {};
+        Bitboard partAttacks[4][64] = {};
+        int counts[4] = {};
+        for (int i = 0; i < 4; ++i) {
+            Bitboard ray = relevantRay(ORDER[i], square);
+            Bitboard subset = 0;
+            do {
+                parts[i][counts[i]] = subset;
+                partAttacks[i][counts[i]++] = rayAttacks(ORDER[i], square, subset);
+                subset = (subset - ray) & ray;
+            } while (subset);
+        }
+
+        Bitboard magic = ROOK_MAGICS[square];
+        int bitsShift = shift[SLIDER_ROOK][square];
+        unsigned index = base;
+        for (int n = 0; n < counts[3]; ++n) {
+            for (int e = 0; e < counts[2]; ++e) {
+                Bitboard upper = parts[3][n] | parts[2][e];
+                Bitboard upperAttacks = partAttacks[3][n] | partAttacks[2][e];
+                for (int w = 0; w < counts[1]; ++w) {
+                    Bitboard outer = upper | parts[1][w];
+                    Bitboard outerAttacks = upperAttacks | partAttacks[1][w];
+                    for (int s = 0; s < counts[0]; ++s) {
+                        Bitboard attacks = outerAttacks | partAttacks[0][s];
+                        magicAttacks[base + (((outer | parts[0][s]) * magic) >> bitsShift)] = attacks;
+                        pextAttacks[index++] = attacks;
+                    }
+                }
+            }
+        }
+    }
+};
+
+inline constexpr SliderTables SLIDER_TABLES{};
+
+inline Bitboard magicSliderAttacks(SliderKind kind, int square, Bitboard occupied) {
+    const SliderTables& t = SLIDER_TABLES;
+    return t.magicAttacks[t.offset[kind][square] +
+        (((occupied & t.mask[kind][square]) * (kind == SLIDER_ROOK ? ROOK_MAGICS : BISHOP_MAGICS)[square]) >>
+            t.shift[kind][square])];
+}
+
+#ifdef BITBOARD_PEXT_AVAILABLE
+inline bool cpuHasBmi2() {
+    unsigned ebx;
+#ifdef _MSC_VER
+    int regs[4];
+    __cpuidex(regs, 7, 0);
+    ebx = static_cast<unsigned>(regs[1]);
+#else
+    unsigned eax, ecx, edx;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) return false;
+#endif
+    return (ebx >> 8) & 1;
+}
+
+#if !defined(_MSC_VER) && !defined(__BMI2__)
+__attribute__((target("bmi2")))
+#endif
+inline Bitboard pextSliderAttacks(SliderKind kind, int square, Bitboard occupied) {
+    const SliderTables& t = SLIDER_TABLES;
+    return t.pextAttacks[t.offset[kind][square] + _pext_u64(occupied, t.mask[kind][square])];
+}
+
+inline const bool BITBOARD_CPU_HAS_BMI2 = cpuHasBmi2();
+
+// Out of line, behind the target attribute GCC and Clang need without
+// -mbmi2, PEXT measured slower than an inlined magic multiply; MSVC inlines
+// _pext_u64 without any flag.
+#if defined(_MSC_VER) || defined(__BMI2__)
+inline const bool BITBOARD_USE_PEXT = BITBOARD_CPU_HAS_BMI2;
+#else
+const bool BITBOARD_USE_PEXT = false;
+#endif
+#else
+const bool BITBOARD_CPU_HAS_BMI2 = false;
+const bool BITBOARD_USE_PEXT = false;
+#endif
+
+inline Bitboard sliderAttacks(SliderKind kind, int square, Bitboard occupied) {
+#ifdef BITBOARD_PEXT_AVAILABLE
+    if (BITBOARD_USE_PEXT) return pextSliderAttacks(kind, square, occupied);
+#endif
+    return magicSliderAttacks(kind, square, occupied);
+}
+
+inline Bitboard bishopAttacks(int square, Bitboard occupied) {
+    return sliderAttacks(SLIDER_BISHOP, square, occupied);
+}
+
+inline Bitboard rookAttacks(int square, Bitboard occupied) {
+    return sliderAttacks(SLIDER_ROOK, square, occupied);
+}
+
+inline Bitboard knightAttacks(int square) {
+    return BITBOARD_TABLES.knight[square];
+}
+
+inline Bitboard kingAttacks(int square) {
+    return BITBOARD_TABLES.king[square];
+}
+
+// color 0 for white, 1 for black.
+inline Bitboard pawnAttacks(int color, int square) {
+    return BITBOARD_TABLES.pawn[color][square];
+}
+
+inline Bitboard betweenSquares(int a, int b) {
+    return BITBOARD_TABLES.between[a][b];
+}
+
+inline Bitboard lineThrough(int a, int b) {
+    return BITBOARD_TABLES.line[a][b];
+}
@@ -0,0 +1,37 @@
+// bot_difficulty.hpp
+#pragma once
+#include "search_limits.hpp"
+#include <cstdint>
+
+// What one difficulty costs and how well it plays. Strength comes from
+// UCI_Elo where the engine has it and Skill Level otherwise; the node budget
+// bounds every search, so weak bots are also cheap ones. `level` is the
+// Skill Level, and names the difficulty in metrics and the result cache.
+struct BotDifficulty {
+    int level = 20;
+    int elo = 0;            // 0: full strength, UCI_LimitStrength off
+    uint64_t nodes = 0;     // per move, also a cap under a clock; 0 for none
+
+    SearchLimits limits() const {
+        return nodes > 0 ? SearchLimits::fixedNodes(nodes) : SearchLimits::fixedDepth(10);
+    }
+};
+
+// Skill Level 0, 10 and 20 are the menu's three buttons. Stockfish's
+// UCI_Elo starts at 1320.
+inline BotDifficulty botDifficulty(int level) {
+    BotDifficulty difficulty;
+    difficulty.level = level;
+    if (level <= 0) {
+        difficulty.elo = 1320;
+        difficulty.nodes = 10000;
+    }
+    else if (level <= 10) {
+        difficulty.elo = 2000;
+        difficulty.nodes = 100000;
+    }
+    else {
+        difficulty.nodes = 500000;
+    }
+    return difficulty;
+}
@@ -1,11 +1,14 @@
 #include "chess_game.h"
-#include "engine.hpp"
+#include "engine_pool.hpp"
+#include "engine_speculation.hpp"
+#include "chess_position.hpp"
 #include <SFML/Graphics.hpp>
 #include <SFML/Audio.hpp>
 #include <iostream>
 #include <cstring>
 #include <fstream>
 #include <algorithm>
+#include <cstdio>
 
 const int TILE_SIZE = 100;
 const sf::Vector2f BOARD_POSITION(560, 140);
@@ -13,6 +16,7 @@ const int MAX_PIECES = 32;
 const std::string LOG_FILENAME = "chess_results.txt";
 const std::string PLAYER_NAME = "Player";
 const std::string BOT_NAME = "Stockfish";
+const int BOT_MOVE_RETRIES = 1; //  ,      
 
 struct GameSounds {
     sf::SoundBuffer moveBuffer;
@@ -159,6 +163,21 @@ struct GameOverScreen {
         updatePositions();
     }
 
+    void setAborted() {
+        message.setString(L"  ");
+        updatePositions();
+    }
+
+    void setDraw(GameEnd end) {
+        switch (end) {
+        case GameEnd::Stalemate: message.setString(L". "); break;
+        case GameEnd::InsufficientMaterial: message.setString(L":  "); break;
+        case GameEnd::Repetition: message.setString(L": "); break;
+        default: message.setString(L": 50 "); break;
+        }
+        updatePositions();
+    }
+
     void updatePositions() {
         sf::FloatRect textRect = message.getLocalBounds();
         message.setOrigin(textRect.left + textRect.width / 2.0f,
@@ -195,6 +214,160 @@ struct GameOverScreen {
     }
 };
 
+struct GameClock {
+    sf::Text whiteText;
+    sf::Text blackText;
+    sf::Clock turnClock;
+    int remainingMs[2] = { 0, 0 }; // [0]  , [1]  
+    int incrementMs = 0;
+    bool enabled = false;
+    bool running = false;
+    bool whiteToMove = true;
+
+    GameClock(sf::Font& font, const TimeControl& control) {
+        whiteText.setFont(font);
+        whiteText.setCharacterSize(50);
+        whiteText.setPosition(BOARD_POSITION.x + 8 * TILE_SIZE + 40, BOARD_POSITION.y + 8 * TILE_SIZE - 60);
+
+        blackText.setFont(font);
+        blackText.setCharacterSize(50);
+        blackText.setPosition(BOARD_POSITION.x + 8 * TILE_SIZE + 40, BOARD_POSITION.y);
+
+        reset(control);
+    }
+
+    void reset(const TimeControl& control) {
+        enabled = control.enabled();
+        remainingMs[0] = remainingMs[1] = control.baseMs;
+        incrementMs = control.incrementMs;
+        running = false;
+        whiteToMove = true;
+        updateTexts();
+    }
+
+    void start() {
+        if (!enabled) return;
+        running = true;
+        turnClock.restart();
+    }
+
+    //     ,      .
+    void press() {
+        if (!enabled) return;
+        update();
+        remainingMs[whiteToMove ? 0 : 1] += incrementMs;
+        whiteToMove = !whiteToMove;
+        updateTexts();
+    }
+
+    void update() {
+        if (!running) return;
+        int elapsed = turnClock.restart().asMilliseconds();
+        int& remaining = remainingMs[whiteToMove ? 0 : 1];
+        remaining = std::max(0, remaining - elapsed);
+        updateTexts();
+    }
+
+    bool flagged() const {
+        return enabled && remainingMs[whiteToMove ? 0 : 1] == 0;
+    }
+
+    SearchLimits limits() const {
+        return SearchLimits::clock(remainingMs[0], remainingMs[1], incrementMs, incrementMs);
+    }
+
+    static std::string format(int ms) {
+        int seconds = ms / 1000;
+        char buf[16];
+        if (ms < 10000) snprintf(buf, sizeof(buf), "%d.%d", seconds, (ms % 1000) / 100);
+        else snprintf(buf, sizeof(buf), "%d:%02d", seconds / 60, seconds % 60);
+        return buf;
+    }
+
+    void updateTexts() {
+        whiteText.setString(format(remainingMs[0]));
+        blackText.setString(format(remainingMs[1]));
+        whiteText.setFillColor(whiteToMove ? sf::Color(200, 170, 50) : sf::Color::White);
+        blackText.setFillColor(whiteToMove ? sf::Color::White : sf::Color(200, 170, 50));
+    }
+
+    void draw(sf::RenderWindow& window) {
+        if (!enabled) return;
+        window.draw(whiteText);
+        window.draw(blackText);
+    }
+};
+
+//        ,  F3.
+struct MetricsOverlay {
+    sf::RectangleShape background;
+    sf::Text text;
+    sf::Clock refreshClock;
+    bool visible = false;
+    int level = 0;
+
+    MetricsOverlay(sf::Font& font, int level) : level(level) {
+        background.setFillColor(sf::Color(0, 0, 0, 170));
+        background.setPosition(20, 140);
+
+        text.setFont(font);
+        text.setCharacterSize(20);
+        text.setFillColor(sf::Color::White);
+        text.setPosition(30, 150);
+    }
+
+    void toggle() {
+        visible = !visible;
+        if (visible) refresh();
+    }
+
+    void refresh() {
+        std::string lines = "engine, level " + std::to_string(level) + "   p50 / p99 (n)\n";
+        const EngineMetrics& metrics = EngineMetrics::instance();
+        for (int m = 0; m < METRIC_COUNT; ++m) {
+            EngineMetric metric = static_cast<EngineMetric>(m);
+            uint64_t p50, p99, count;
+            //       .
+            int bucket = metric == METRIC_HANDSHAKE_US ? -1 : level;
+            if (!metrics.summary(bucket, metric, p50, p99, count)) continue;
+
+            char row[96];
+            snprintf(row, sizeof(row), "%-13s %10llu / %llu (%llu)\n", EngineMetrics::metricName(metric),
+                static_cast<unsigned long long>(p50), static_cast<unsigned long long>(p99),
+                static_cast<unsigned long long>(count));
+            lines += row;
+        }
+        ResultCacheStats cache = EngineResultCache::shared().stats();
+        char row[96];
+        snprintf(row, sizeof(row), "cache         %5.1f%% hits (%llu / %llu)\n", cache.hitRate() * 100.0,
+            static_cast<unsigned long long>(cache.hits), static_cast<unsigned long long>(cache.hits + cache.misses));
+        lines += row;
+        SpeculationStats speculation = EngineSpeculation::stats(level);
+        snprintf(row, sizeof(row), "speculation   %5.1f%% hits (%llu / %llu), %.0f%% wasted\n",
+            speculation.hitRate() * 100.0, static_cast<unsigned long long>(speculation.hits),
+            static_cast<unsigned long long>(speculation.rounds), speculation.wastedShare() * 100.0);
+        lines += row;
+        text.setString(lines);
+        sf::FloatRect bounds = text.getLocalBounds();
+        background.setSize(sf::Vector2f(bounds.width + 30, bounds.height + 30));
+        refreshClock.restart();
+    }
+
+    void draw(sf::RenderWindow& window) {
+        if (!visible) return;
+        if (refreshClock.getElapsedTime().asMilliseconds() >= 500) refresh();
+        window.draw(background);
+        window.draw(text);
+    }
+};
+
+SearchLimits botSearchLimits(const ChessGameSettings& settings, const GameClock& clock) {
+    if (!clock.enabled) return settings.botLimits;
+    SearchLimits limits = clock.limits();
+    if (settings.botLimits.mode == SearchLimits::Nodes) limits.nodes = settings.botLimits.nodes;
+    return limits;
+}
+
 int getTextureIndex(int piece) {
     switch (abs(piece)) {
     case 1: return 5; // pawn
@@ -213,6 +386,15 @@ std::string toChessNotation(int x, int y) {
     return std::string(1, file) + std::string(1, rank);
 }
 
+char promotionSuffix(int piece) {
+    switch (piece) {
+    case 2: return 'n';
+    case 3: return 'b';
+    case 4: return 'r';
+    default: return 'q';
+    }
+}
+
 bool isValidCoordinate(int x, int y) {
     return x >= 0 && x < 8 && y >= 0 && y < 8;
 }
@@ -259,61 +441,42 @@ int findPieceIndex(PieceSprite pieces[], int pieceCount, int x, int y) {
     return -1;
 }
 
-bool applyMove(int layout[8][8], const std::string& move, PieceSprite pieces[], int& pieceCount,
-    sf::Texture& pieceTex, PromotionWindow& promoWindow, GameSounds& sounds) {
-    if (move.length() < 4) return false;
-
-    int fromX = move[0] - 'a';
-    int fromY = 7 - (move[1] - '1');
-    int toX = move[2] - 'a';
-    int toY = 7 - (move[3] - '1');
-
-    if (!isValidCoordinate(fromX, fromY) || !isValidCoordinate(toX, toY))
+//         .  
+//      :      ,
+//       .
+bool applyMove(ChessPosition& position, PositionHistory& history, int layout[8][8], const std::string& move,
+    PieceSprite pieces[], int& pieceCount, sf::Texture& pieceTex, PromotionWindow& promoWindow, GameSounds& sounds) {
+    UciMove parsed = parseUciMove(move);
+    if (parsed == UCI_MOVE_NONE) return false;
+
+    int from = uciMoveFrom(parsed), to = uciMoveTo(parsed);
+    bool choosePromotion = position.isPromotion(parsed) && uciMovePromotion(parsed) == UCI_PROMO_NONE;
+    if (!position.isLegal(choosePromotion ? makeUciMove(from, to, UCI_PROMO_QUEEN) : parsed))
         return false;
 
-    int piece = layout[fromY][fromX];
-    int capturedPiece = layout[toY][toX];
-    bool isCapture = (capturedPiece != 0);
-
-    if (abs(piece) == 6 && abs(fromX - toX) == 2) {
-        bool isKingside = (toX > fromX);
-        int rookFromX = isKingside ? 7 : 0;
-        int rookToX = isKingside ? 5 : 3;
-
-        layout[fromY][rookToX] = layout[fromY][rookFromX];
-        layout[fromY][rookFromX] = 0;
-        updatePieceSprites(pieces, pieceCount, layout, pieceTex);
-    }
-    else if (abs(piece) == 1 && (toY == 0 || toY == 7)) {
+    int toX = to & 7, toY = 7 - (to >> 3);
+    if (choosePromotion) {
+        layout[toY][toX] = layout[7 - (from >> 3)][from & 7];
+        layout[7 - (from >> 3)][from & 7] = 0;
         promoWindow.setPosition(BOARD_POSITION.x + toX * TILE_SIZE + TILE_SIZE / 2,
             BOARD_POSITION.y + toY * TILE_SIZE + TILE_SIZE / 2,
-            piece > 0);
+            position.whiteToMove());
         promoWindow.visible = true;
         promoWindow.promotionPos = sf::Vector2i(toX, toY);
+        return true;
     }
-    else {
-        if (isCapture) sounds.captureSound.play();
-        else sounds.moveSound.play();
-    }
-
-    layout[toY][toX] = piece;
-    layout[fromY][fromX] = 0;
 
-    if (!promoWindow.visible) {
-        updatePieceSprites(pieces, pieceCount, layout, pieceTex);
-    }
+    if (position.isCapture(parsed)) sounds.captureSound.play();
+    else sounds.moveSound.play();
 
+    position.play(parsed);
+    history.push(position);
+    position.toLayout(layout);
+    updatePieceSprites(pieces, pieceCount, layout, pieceTex);
     return true;
 }
 
-bool checkForMate(ChessEngine& engine, const std::string& moveHistory, bool whiteToMove) {
-    engine.SendCommand("position startpos moves " + moveHistory);
-    engine.SendCommand("go depth 1");
-    std::string response = engine.GetResponse(5000);
-    return response.find("mate 0") != std::string::npos || response.find("stalemate") != std::string::npos;
-}
-
-void logGameResult(bool isWhiteWinner) {
+void logGameLine(const std::string& result) {
     std::ofstream logFile(LOG_FILENAME, std::ios::app);
     if (!logFile.is_open()) {
         std::cerr << "Error: Could not open log file!" << std::endl;
@@ -325,52 +488,109 @@ void logGameResult(bool isWhiteWinner) {
     std::string line;
     while (std::getline(inFile, line)) gameNumber++;
 
-    logFile << gameNumber + 1 << ". " << (isWhiteWinner ? "White wins" : "Black wins") << "\n";
+    logFile << gameNumber + 1 << ". " << result << "\n";
 }
 
-void makeBotMove(ChessEngine& engine, int layout[8][8], std::string& moveHistory,
-    PieceSprite pieces[], int& pieceCount, sf::Texture& pieceTex,
-    const ChessGameSettings& settings, bool& gameOver, PromotionWindow& promoWindow,
-    GameSounds& sounds, GameOverScreen& gameOverScreen, int difficulty) {
-
-    engine.SendCommand("go depth " + std::to_string(settings.engineDepth));
-    std::string botResponse = engine.GetResponse(10000);
+void logGameResult(bool isWhiteWinner) {
+    logGameLine(isWhiteWinner ? "White wins" : "Black wins");
+}
 
-    size_t bestMovePos = botResponse.find("bestmove ");
-    if (bestMovePos != std::string::npos) {
-        std::string botMove = botResponse.substr(bestMovePos + 9, 4);
+//       ,     .
+bool declareGameEnd(const ChessPosition& position, const PositionHistory& history,
+    bool& gameOver, GameOverScreen& gameOverScreen) {
+    GameEnd end = history.gameEnd(position);
+    if (end == GameEnd::None) return false;
+
+    gameOver = true;
+    gameOverScreen.visible = true;
+    if (end == GameEnd::Checkmate) {
+        //   ,   .
+        gameOverScreen.setWinner(!position.whiteToMove());
+        logGameResult(!position.whiteToMove());
+        return true;
+    }
+    gameOverScreen.setDraw(end);
+    switch (end) {
+    case GameEnd::Stalemate: logGameLine("Draw (stalemate)"); break;
+    case GameEnd::InsufficientMaterial: logGameLine("Draw (insufficient material)"); break;
+    case GameEnd::Repetition: logGameLine("Draw (repetition)"); break;
+    default: logGameLine("Draw (fifty moves)"); break;
+    }
+    return true;
+}
 
-        if (applyMove(layout, botMove, pieces, pieceCount, pieceTex, promoWindow, sounds)) {
-            moveHistory += (moveHistory.empty() ? "" : " ") + botMove;
+// false,    (    )  : 
+//  -  .
+bool makeBotMove(ChessPosition& position, PositionHistory& history, const std::string& botMove,
+    int layout[8][8], std::string& moveHistory, PieceSprite pieces[], int& pieceCount, sf::Texture& pieceTex,
+    bool& gameOver, PromotionWindow& promoWindow,
+    GameSounds& sounds, GameOverScreen& gameOverScreen) {
+
+    //     ;    .
+    UciMove parsed = parseUciMove(botMove);
+    if (position.isPromotion(parsed) && uciMovePromotion(parsed) == UCI_PROMO_NONE) {
+        parsed = makeUciMove(uciMoveFrom(parsed), uciMoveTo(parsed), UCI_PROMO_QUEEN);
+    }
+    std::string move = uciMoveToString(parsed);
 
-            int toY = 7 - (botMove[3] - '1');
-            int toX = botMove[2] - 'a';
-            int piece = layout[toY][toX];
-            bool isPawnPromotion = (abs(piece) == 1) && (toY == 0 || toY == 7);
+    if (move.empty() || !applyMove(position, history, layout, move, pieces, pieceCount, pieceTex, promoWindow, sounds))
+        return false;
+    moveHistory += (moveHistory.empty() ? "" : " ") + move;
+    declareGameEnd(position, history, gameOver, gameOverScreen);
+    return true;
+}
 
-            if (isPawnPromotion) {
-                layout[toY][toX] = (piece > 0) ? 5 : -5;
+//      ,  
+// ,   . nullptr,     
+//  ,  .
+std::unique_ptr<ChessEngine> waitForEngine(sf::RenderWindow& window, EngineRequest& request, sf::Font& font,
+    const sf::Sprite& board, sf::Sprite& backButton, const ChessGameSettings& settings) {
+    sf::Text waiting;
+    waiting.setFont(font);
+    waiting.setString(L" ...");
+    waiting.setCharacterSize(40);
+    waiting.setFillColor(sf::Color::White);
+    sf::FloatRect bounds = waiting.getLocalBounds();
+    waiting.setOrigin(bounds.left + bounds.width / 2.0f, bounds.top + bounds.height / 2.0f);
+    waiting.setPosition(BOARD_POSITION.x + 4 * TILE_SIZE, BOARD_POSITION.y + 4 * TILE_SIZE);
+    sf::RectangleShape shade;
+    shade.setSize(sf::Vector2f(8 * TILE_SIZE, 8 * TILE_SIZE));
+    shade.setPosition(BOARD_POSITION);
+    shade.setFillColor(sf::Color(0, 0, 0, 150));
+
+    while (window.isOpen() && !request.poll()) {
+        sf::Event event;
+        while (window.pollEvent(event)) {
+            if (event.type == sf::Event::Closed) {
+                window.close();
+                return nullptr;
             }
-
-            updatePieceSprites(pieces, pieceCount, layout, pieceTex);
-
-            if (checkForMate(engine, moveHistory, true)) {
-                gameOver = true;
-                gameOverScreen.visible = true;
-                gameOverScreen.setWinner(false);
-                logGameResult(false);
+            if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left &&
+                backButton.getGlobalBounds().contains(static_cast<float>(event.mouseButton.x),
+                    static_cast<float>(event.mouseButton.y))) {
+                if (settings.backgroundMusic) settings.backgroundMusic->play();
+                return nullptr;
             }
         }
+
+        window.clear(sf::Color(50, 50, 50));
+        window.draw(board);
+        window.draw(shade);
+        window.draw(waiting);
+        window.draw(backButton);
+        window.display();
     }
+    std::unique_ptr<ChessEngine> engine = request.take();
+    if (!engine && window.isOpen()) std::cerr << "Failed to start Stockfish!\n";
+    return engine;
 }
 
 void runChessGame(sf::RenderWindow& window, const ChessGameSettings& settings, int level) {
-    ChessEngine engine;
-    if (!engine.ConnectToEngine(L"stockfish.exe")) {
-        std::cerr << "Failed to start Stockfish!\n";
-        return;
-    }
-    engine.setDifficulty(level);
+    //         ,   
+    //   ,     .  
+    //   ,   .
+    if (settings.speculation > 0) EnginePool::instance().warmUp(settings.speculation);
+    EngineRequest engineRequest;
 
     GameSounds sounds;
     if (!sounds.loadSounds()) {
@@ -398,19 +618,26 @@ void runChessGame(sf::RenderWindow& window, const ChessGameSettings& settings, i
     backButton.setScale(0.10f, 0.10f);
     backButton.setPosition(20, 20);
 
+    EngineLease lease(waitForEngine(window, engineRequest, font, board, backButton, settings));
+    if (!lease) return;
+    ChessEngine& engine = *lease;
+    engine.setDifficulty(level);
+    engine.setResultCache(&EngineResultCache::shared());
+
+    //         .
+    EngineSpeculation speculation(level, settings.speculation);
+
     GameOverScreen gameOverScreen(font);
     PromotionWindow promotionWindow(font, pieceTex);
+    GameClock gameClock(font, settings.timeControl);
+    MetricsOverlay metricsOverlay(font, level);
 
-    int layout[8][8] = {
-        {-4, -2, -3, -5, -6, -3, -2, -4},
-        {-1, -1, -1, -1, -1, -1, -1, -1},
-        { 0,  0,  0,  0,  0,  0,  0,  0},
-        { 0,  0,  0,  0,  0,  0,  0,  0},
-        { 0,  0,  0,  0,  0,  0,  0,  0},
-        { 0,  0,  0,  0,  0,  0,  0,  0},
-        { 1,  1,  1,  1,  1,  1,  1,  1},
-        { 4,  2,  3,  5,  6,  3,  2,  4}
-    };
+    //  ,   ; layout     .
+    ChessPosition position;
+    PositionHistory history;
+    history.reset(position);
+    int layout[8][8];
+    position.toLayout(layout);
 
     bool isWhiteTurn = true;
     bool gameOver = false;
@@ -424,29 +651,50 @@ void runChessGame(sf::RenderWindow& window, const ChessGameSettings& settings, i
     bool dragging = false;
     sf::Sprite draggedSprite;
     bool hoverBack = false;
+    BestMoveFuture botMove;
+    int botRetries = 0;
+
+    //   ,       .
+    auto stopEngines = [&]() {
+        botMove.stop();
+        speculation.cancel();
+        engine.stopPonder();
+    };
+
+    gameClock.start();
+    speculation.start(moveHistory, position, history, botSearchLimits(settings, gameClock));
 
     while (window.isOpen()) {
         sf::Event event;
         while (window.pollEvent(event)) {
             if (event.type == sf::Event::Closed) {
-                engine.SafeClose();
+                botMove.stop();
                 window.close();
             }
 
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F3) {
+                metricsOverlay.toggle();
+            }
+
             if (promotionWindow.visible && promotionWindow.handleEvent(event, window)) {
-                int promoX = promotionWindow.promotionPos.x;
-                int promoY = promotionWindow.promotionPos.y;
-                int color = (layout[promoY][promoX] > 0) ? 1 : -1;
-                layout[promoY][promoX] = promotionWindow.selectedPiece * color;
+                std::string pawnMove = moveHistory.substr(moveHistory.rfind(' ') + 1);
+                moveHistory += promotionSuffix(promotionWindow.selectedPiece);
+                position.play(parseUciMove(pawnMove + promotionSuffix(promotionWindow.selectedPiece)));
+                history.push(position);
+                position.toLayout(layout);
                 updatePieceSprites(pieces, pieceCount, layout, pieceTex);
 
                 isWhiteTurn = !isWhiteTurn;
+                gameClock.press();
 
-                if (!isWhiteTurn) {
-                    makeBotMove(engine, layout, moveHistory, pieces, pieceCount,
-                        pieceTex, settings, gameOver, promotionWindow, sounds,
-                        gameOverScreen, level);
-                    isWhiteTurn = true;
+                if (declareGameEnd(position, history, gameOver, gameOverScreen)) {
+                    stopEngines();
+                }
+                else if (!isWhiteTurn) {
+                    BestMoveFuture speculativeReply = speculation.resolve(moveHistory.substr(moveHistory.rfind(' ') + 1));
+                    botMove = speculativeReply.valid() ? speculativeReply :
+                        engine.getBestMoveAsync(moveHistory, botSearchLimits(settings, gameClock),
+                            ResultCachePosition::of(position, history));
                 }
                 continue;
             }
@@ -457,28 +705,26 @@ void runChessGame(sf::RenderWindow& window, const ChessGameSettings& settings, i
 
                 if (gameOverScreen.isMenuButtonClicked(mousePos)) {
                     if (settings.backgroundMusic) settings.backgroundMusic->play();
-                    engine.SafeClose();
+                    botMove.stop();
                     return;
                 }
                 else if (gameOverScreen.isRestartButtonClicked(mousePos)) {
+                    botMove.stop();
+                    engine.newGame();
                     gameOver = false;
                     gameOverScreen.visible = false;
 
-                    int newLayout[8][8] = {
-                        {-4, -2, -3, -5, -6, -3, -2, -4},
-                        {-1, -1, -1, -1, -1, -1, -1, -1},
-                        { 0,  0,  0,  0,  0,  0,  0,  0},
-                        { 0,  0,  0,  0,  0,  0,  0,  0},
-                        { 0,  0,  0,  0,  0,  0,  0,  0},
-                        { 0,  0,  0,  0,  0,  0,  0,  0},
-                        { 1,  1,  1,  1,  1,  1,  1,  1},
-                        { 4,  2,  3,  5,  6,  3,  2,  4}
-                    };
-                    memcpy(layout, newLayout, sizeof(layout));
+                    position.setStartPosition();
+                    history.reset(position);
+                    position.toLayout(layout);
 
                     isWhiteTurn = true;
+                    botRetries = 0;
                     moveHistory.clear();
                     updatePieceSprites(pieces, pieceCount, layout, pieceTex);
+                    gameClock.reset(settings.timeControl);
+                    gameClock.start();
+                    speculation.start(moveHistory, position, history, botSearchLimits(settings, gameClock));
                 }
             }
 
@@ -492,14 +738,14 @@ void runChessGame(sf::RenderWindow& window, const ChessGameSettings& settings, i
             if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left && !gameOver && !promotionWindow.visible) {
                 if (hoverBack) {
                     if (settings.backgroundMusic) settings.backgroundMusic->play();
-                    engine.SafeClose();
+                    botMove.stop();
                     return;
                 }
 
                 int boardX = static_cast<int>((mousePos.x - BOARD_POSITION.x) / TILE_SIZE);
                 int boardY = static_cast<int>((mousePos.y - BOARD_POSITION.y) / TILE_SIZE);
 
-                if (isValidCoordinate(boardX, boardY)) {
+                if (isValidCoordinate(boardX, boardY) && !botMove.valid()) {
                     int piece = layout[boardY][boardX];
                     if ((isWhiteTurn && piece > 0) || (!isWhiteTurn && piece < 0)) {
                         dragFromX = boardX;
@@ -528,40 +774,32 @@ void runChessGame(sf::RenderWindow& window, const ChessGameSettings& settings, i
                 if (isValidCoordinate(toX, toY)) {
                     std::string move = toChessNotation(dragFromX, dragFromY) + toChessNotation(toX, toY);
 
-                    if ((isWhiteTurn && layout[toY][toX] <= 0) || (!isWhiteTurn && layout[toY][toX] >= 0)) {
-                        int tempLayout[8][8];
-                        memcpy(tempLayout, layout, sizeof(tempLayout));
-
-                        if (applyMove(tempLayout, move, pieces, pieceCount, pieceTex, promotionWindow, sounds)) {
-                            std::string newHistory = moveHistory.empty() ? move : moveHistory + " " + move;
-                            engine.SendCommand("position startpos moves " + newHistory);
-                            engine.SendCommand("isready");
-                            std::string response = engine.GetResponse(5000);
-
-                            if (response.find("readyok") != std::string::npos) {
-                                memcpy(layout, tempLayout, sizeof(layout));
-                                moveHistory = newHistory;
-                                validMove = true;
-
-                                if (!promotionWindow.visible) {
-                                    isWhiteTurn = !isWhiteTurn;
-                                    updatePieceSprites(pieces, pieceCount, layout, pieceTex);
-
-                                    if (checkForMate(engine, moveHistory, !isWhiteTurn)) {
-                                        gameOver = true;
-                                        gameOverScreen.visible = true;
-                                        gameOverScreen.setWinner(!isWhiteTurn);
-                                        logGameResult(!isWhiteTurn);
-                                    }
-
-                                    if (!isWhiteTurn && !gameOver) {
-                                        makeBotMove(engine, layout, moveHistory, pieces, pieceCount,
-                                            pieceTex, settings, gameOver, promotionWindow, sounds,
-                                            gameOverScreen, level);
-                                        isWhiteTurn = true;
-                                    }
-                                }
+                    if (applyMove(position, history, layout, move, pieces, pieceCount, pieceTex, promotionWindow, sounds)) {
+                        //    ,     .
+                        //    ,       .
+                        BestMoveFuture ponderReply = engine.resolvePonder(move);
+                        bool ponderHit = ponderReply.valid();
+                        moveHistory = moveHistory.empty() ? move : moveHistory + " " + move;
+                        validMove = true;
+
+                        if (!promotionWindow.visible) {
+                            isWhiteTurn = !isWhiteTurn;
+                            gameClock.press();
+                            updatePieceSprites(pieces, pieceCount, layout, pieceTex);
+
+                            if (declareGameEnd(position, history, gameOver, gameOverScreen)) {
+                                ponderReply.stop();
+                                stopEngines();
+                            }
+
+                            if (!isWhiteTurn && !gameOver) {
+                                //        .
+                                BestMoveFuture speculativeReply = ponderHit ? BestMoveFuture() : speculation.resolve(move);
+                                botMove = ponderHit ? ponderReply : speculativeReply.valid() ? speculativeReply :
+                                    engine.getBestMoveAsync(moveHistory, botSearchLimits(settings, gameClock),
+                                        ResultCachePosition::of(position, history));
                             }
+                            speculation.cancel();
                         }
                     }
                 }
@@ -576,8 +814,65 @@ void runChessGame(sf::RenderWindow& window, const ChessGameSettings& settings, i
             }
         }
 
+        speculation.poll();
+
+        if (botMove.valid() && botMove.ready()) {
+            std::string reply = botMove.get();
+            std::string expectedReply = botMove.ponder();
+            sf::Clock applyClock;
+            bool applied = makeBotMove(position, history, reply, layout, moveHistory, pieces, pieceCount,
+                pieceTex, gameOver, promotionWindow, sounds, gameOverScreen);
+            EngineMetrics::instance().record(level, METRIC_APPLY_US, applyClock.getElapsedTime().asMicroseconds());
+
+            botMove = BestMoveFuture();
+            if (!applied) {
+                //    ,    .    
+                //  ;      ,  .
+                if (botRetries < BOT_MOVE_RETRIES) {
+                    ++botRetries;
+                    botMove = BestMoveFuture(engine, engine.startSearch(moveHistory, botSearchLimits(settings, gameClock),
+                        ResultCachePosition::of(position, history)));
+                }
+                else {
+                    std::cerr << "Engine gave no legal move: \"" << reply << "\"\n";
+                    stopEngines();
+                    gameOver = true;
+                    gameOverScreen.visible = true;
+                    gameOverScreen.setAborted();
+                    logGameLine("Aborted (engine gave no legal move)");
+                }
+            }
+            else {
+                botRetries = 0;
+                if (gameOver) stopEngines();
+                isWhiteTurn = true;
+                gameClock.press();
+
+                if (settings.ponder && !gameOver) {
+                    engine.startPonder(moveHistory, expectedReply, botSearchLimits(settings, gameClock),
+                        ResultCachePosition::after(position, history, expectedReply));
+                }
+                if (!gameOver) {
+                    speculation.start(moveHistory, position, history, botSearchLimits(settings, gameClock),
+                        settings.ponder ? expectedReply : "");
+                }
+            }
+        }
+
+        if (!gameOver) {
+            gameClock.update();
+            if (gameClock.flagged()) {
+                stopEngines();
+                gameOver = true;
+                gameOverScreen.visible = true;
+                gameOverScreen.setWinner(!gameClock.whiteToMove);
+                logGameResult(!gameClock.whiteToMove);
+            }
+        }
+
         window.clear(sf::Color(50, 50, 50));
         window.draw(board);
+        gameClock.draw(window);
 
         for (int i = 0; i < pieceCount; ++i) {
             if (pieces[i].alive) {
@@ -592,8 +887,7 @@ void runChessGame(sf::RenderWindow& window, const ChessGameSettings& settings, i
         window.draw(backButton);
         gameOverScreen.draw(window);
         promotionWindow.draw(window);
+        metricsOverlay.draw(window);
         window.display();
     }
-
-    engine.SafeClose();
 }
\ No newline at end of file
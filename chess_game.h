@@ -2,13 +2,26 @@
 #pragma once
 #include <SFML/Graphics.hpp>
 #include <SFML/Audio.hpp>
+#include "search_limits.hpp"
+
+struct TimeControl {
+    int baseMs = 0;      // 0    
+    int incrementMs = 0;
+
+    bool enabled() const {
+        return baseMs > 0;
+    }
+};
 
 struct ChessGameSettings {
     sf::Sound* moveSound = nullptr;
     sf::Music* backgroundMusic = nullptr;
     float soundVolume = 50.f;
     float musicVolume = 50.f;
-    int engineDepth = 10; //  
+    SearchLimits botLimits = SearchLimits::fixedDepth(10); //  
+    TimeControl timeControl;
+    bool ponder = true; //      
+    int speculation = 0; //      
 };
 
 void runChessGame(sf::RenderWindow& window, const ChessGameSettings& settings, int levell);
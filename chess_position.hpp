@@ -0,0 +1,568 @@
+// chess_position.hpp
+#pragma once
+#include "bitboard.hpp"
+#include "uci_parser.hpp"
+#include "zobrist.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Piece codes are the game's: 1 pawn .. 6 king, positive for white.
+enum ChessPiece { PIECE_NONE = 0, PAWN = 1, KNIGHT, BISHOP, ROOK, QUEEN, KING };
+
+enum CastlingRight { CASTLE_WHITE_KING = 1, CASTLE_WHITE_QUEEN = 2, CASTLE_BLACK_KING = 4, CASTLE_BLACK_QUEEN = 8 };
+
+// How a game ended, as far as the rules alone decide it.
+enum class GameEnd { None, Checkmate, Stalemate, InsufficientMaterial, FiftyMoves, Repetition };
+
+const char START_FEN[] = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+// Every legal move of a position fits; the known maximum is 218.
+struct MoveList {
+    UciMove moves[256];
+    int count = 0;
+
+    void add(UciMove move) { moves[count++] = move; }
+    const UciMove* begin() const { return moves; }
+    const UciMove* end() const { return moves + count; }
+
+    bool contains(UciMove move) const {
+        for (UciMove listed : *this) {
+            if (listed == move) return true;
+        }
+        return false;
+    }
+};
+
+// A position as bitboards per piece type and colour, with a mailbox for
+// "what is on this square". Generates strictly legal moves: pins, checks,
+// castling through attacked squares and the en passant discovered check are
+// all handled, so isLegal is the whole of move validation.
+class ChessPosition {
+private:
+    Bitboard byType[KING + 1];  // [0] unused
+    Bitboard byColor[2];        // [0] white, [1] black
+    int8_t board[64];
+    int side = 0;               // 0 white to move, 1 black
+    int castling = 0;           // CastlingRight bits
+    int enPassant = -1;         // only set when a pawn can actually capture there
+    int halfmoveClock = 0;
+    int fullmoveNumber = 1;
+    uint64_t hashKey = 0;       // Zobrist key, kept up to date by every change
+
+    static int colorOf(int piece) { return piece > 0 ? 0 : 1; }
+
+    Bitboard occupied() const { return byColor[0] | byColor[1]; }
+
+    Bitboard pieces(int color, int type) const { return byColor[color] & byType[type]; }
+
+    void put(int square, int piece) {
+        board[square] = static_cast<int8_t>(piece);
+        byType[piece > 0 ? piece : -piece] |= squareBit(square);
+        byColor[colorOf(piece)] |= squareBit(square);
+        hashKey ^= ZOBRIST.pieces[colorOf(piece)][piece > 0 ? piece : -piece][square];
+    }
+
+    void remove(int square) {
+        int piece = board[square];
+        board[square] = 0;
+        byType[piece > 0 ? piece : -piece] &= ~squareBit(square);
+        byColor[colorOf(piece)] &= ~squareBit(square);
+        hashKey ^= ZOBRIST.pieces[colorOf(piece)][piece > 0 ? piece : -piece][square];
+    }
+
+    void clear() {
+        memset(byType, 0, sizeof(byType));
+        memset(byColor, 0, sizeof(byColor));
+        memset(board, 0, sizeof(board));
+        side = 0;
+        castling = 0;
+        enPassant = -1;
+        halfmoveClock = 0;
+        fullmoveNumber = 1;
+        hashKey = 0;
+    }
+
+    int kingSquare(int color) const {
+        return lowestSquare(pieces(color, KING));
+    }
+
+    // Pieces of either colour attacking `square` with the given occupancy.
+    Bitboard attackersTo(int square, Bitboard occupancy) const {
+        Bitboard diagonal = byType[BISHOP] | byType[QUEEN];
+        Bitboard straight = byType[ROOK] | byType[QUEEN];
+        return (pawnAttacks(1, square) & pieces(0, PAWN)) | (pawnAttacks(0, square) & pieces(1, PAWN)) |
+            (knightAttacks(square) & byType[KNIGHT]) | (kingAttacks(square) & byType[KING]) |
+            (bishopAttacks(square, occupancy) & diagonal) | (rookAttacks(square, occupancy) & straight);
+    }
+
+    bool attackedBy(int color, int square, Bitboard occupancy) const {
+        return (attackersTo(square, occupancy) & byColor[color]) != 0;
+    }
+
+    // Our pieces that alone stand between our king and an enemy slider.
+    Bitboard pinnedPieces(int king) const {
+        int them = side ^ 1;
+        Bitboard snipers = (rookAttacks(king, 0) & (pieces(them, ROOK) | pieces(them, QUEEN))) |
+            (bishopAttacks(king, 0) & (pieces(them, BISHOP) | pieces(them, QUEEN)));
+        Bitboard occupancy = occupied();
+        Bitboard pinned = 0;
+        while (snipers) {
+            Bitboard blockers = betweenSquares(king, popLowestSquare(snipers)) & occupancy;
+            if (blockers && !moreThanOne(blockers)) pinned |= blockers & byColor[side];
+        }
+        return pinned;
+    }
+
+    static void addPromotions(MoveList& list, int from, int to) {
+        list.add(makeUciMove(from, to, UCI_PROMO_QUEEN));
+        list.add(makeUciMove(from, to, UCI_PROMO_ROOK));
+        list.add(makeUciMove(from, to, UCI_PROMO_BISHOP));
+        list.add(makeUciMove(from, to, UCI_PROMO_KNIGHT));
+    }
+
+    void addPawnMoves(MoveList& list, int king, Bitboard pinned, Bitboard target) const {
+        int them = side ^ 1;
+        int forward = side == 0 ? 8 : -8;
+        int lastRank = side == 0 ? 7 : 0;
+        int startRank = side == 0 ? 1 : 6;
+        Bitboard occupancy = occupied();
+        Bitboard pawns = pieces(side, PAWN);
+
+        while (pawns) {
+            int from = popLowestSquare(pawns);
+            Bitboard allowed = target & (pinned & squareBit(from) ? lineThrough(king, from) : ~0ull);
+
+            Bitboard moves = pawnAttacks(side, from) & byColor[them];
+            int single = from + forward;
+            if (!(occupancy & squareBit(single))) {
+                moves |= squareBit(single);
+                int dbl = single + forward;
+                if ((from >> 3) == startRank && !(occupancy & squareBit(dbl))) moves |= squareBit(dbl);
+            }
+            moves &= allowed;
+
+            while (moves) {
+                int to = popLowestSquare(moves);
+                if ((to >> 3) == lastRank) addPromotions(list, from, to);
+                else list.add(makeUciMove(from, to));
+            }
+
+            // Replayed on the occupancy it leaves behind, which catches the
+            // rank pin through both pawns and a check the capture does not answer.
+            if (enPassant >= 0 && (pawnAttacks(side, from) & squareBit(enPassant))) {
+                int captured = enPassant - forward;
+                Bitboard after = (occupancy ^ squareBit(from) ^ squareBit(captured)) | squareBit(enPassant);
+                if (!(attackersTo(king, after) & byColor[them] & ~squareBit(captured))) {
+                    list.add(makeUciMove(from, enPassant));
+                }
+            }
+        }
+    }
+
+    void addCastling(MoveList& list) const {
+        int them = side ^ 1;
+        int rank = side == 0 ? 0 : 56;
+        int kingRight = side == 0 ? CASTLE_WHITE_KING : CASTLE_BLACK_KING;
+        int queenRight = side == 0 ? CASTLE_WHITE_QUEEN : CASTLE_BLACK_QUEEN;
+        Bitboard occupancy = occupied();
+        int rook = side == 0 ? ROOK : -ROOK;
+
+        if ((castling & kingRight) && board[rank + 7] == rook &&
+            !(occupancy & (squareBit(rank + 5) | squareBit(rank + 6))) &&
+            !attackedBy(them, rank + 5, occupancy) && !attackedBy(them, rank + 6, occupancy)) {
+            list.add(makeUciMove(rank + 4, rank + 6));
+        }
+        if ((castling & queenRight) && board[rank] == rook &&
+            !(occupancy & (squareBit(rank + 1) | squareBit(rank + 2) | squareBit(rank + 3))) &&
+            !attackedBy(them, rank + 3, occupancy) && !attackedBy(them, rank + 2, occupancy)) {
+            list.add(makeUciMove(rank + 4, rank + 2));
+        }
+    }
+
+    // Rights lost when anything moves from or to a square.
+    static int castlingLostAt(int square) {
+        switch (square) {
+        case 0: return CASTLE_WHITE_QUEEN;
+        case 4: return CASTLE_WHITE_KING | CASTLE_WHITE_QUEEN;
+        case 7: return CASTLE_WHITE_KING;
+        case 56: return CASTLE_BLACK_QUEEN;
+        case 60: return CASTLE_BLACK_KING | CASTLE_BLACK_QUEEN;
+        case 63: return CASTLE_BLACK_KING;
+        default: return 0;
+        }
+    }
+
+public:
+    ChessPosition() {
+        setStartPosition();
+    }
+
+    void setStartPosition() {
+        setFen(START_FEN);
+    }
+
+    // Placement, side, castling and en passant are required; the clocks
+    // default to 0 and 1. Leaves the position empty and returns false on
+    // anything malformed (ranks other than 8 files, other than 8 ranks), an
+    // en passant square no double push can have left, or a position
+    // without exactly one king per side. Castling rights whose king or rook
+    // is off its home square are dropped rather than trusted.
+    bool setFen(std::string_view fen) {
+        clear();
+        size_t at = 0;
+        auto field = [&]() {
+            while (at < fen.size() && fen[at] == ' ') ++at;
+            size_t start = at;
+            while (at < fen.size() && fen[at] != ' ') ++at;
+            return fen.substr(start, at - start);
+        };
+        std::string_view placement = field(), color = field(), rights = field(), ep = field();
+        std::string_view halfmove = field(), fullmove = field();
+
+        int rank = 7, file = 0;
+        char previous = 0;
+        for (char c : placement) {
+            if (c == '/') {
+                if (file != 8 || rank == 0) {
+                    clear();
+                    return false;
+                }
+                --rank;
+                file = 0;
+            }
+            else if (c >= '1' && c <= '8') {
+                file += c - '0';
+                if (file > 8 || (previous >= '1' && previous <= '8')) {
+                    clear();
+                    return false;
+                }
+            }
+            else {
+                const char* codes = "pnbrqk";
+                const char* found = c ? strchr(codes, c | 0x20) : nullptr;
+                if (!found || file > 7 || rank < 0) {
+                    clear();
+                    return false;
+                }
+                int piece = static_cast<int>(found - codes) + 1;
+                put(rank * 8 + file, c & 0x20 ? -piece : piece);
+                ++file;
+            }
+            previous = c;
+        }
+        if (rank != 0 || file != 8 ||
+            countSquares(pieces(0, KING)) != 1 || countSquares(pieces(1, KING)) != 1 ||
+            (color != "w" && color != "b")) {
+            clear();
+            return false;
+        }
+        side = color == "w" ? 0 : 1;
+
+        for (char c : rights) {
+            if (c == 'K') castling |= CASTLE_WHITE_KING;
+            else if (c == 'Q') castling |= CASTLE_WHITE_QUEEN;
+            else if (c == 'k') castling |= CASTLE_BLACK_KING;
+            else if (c == 'q') castling |= CASTLE_BLACK_QUEEN;
+        }
+        const int homes[] = { 4, 0, 7, 60, 56, 63 };
+        for (int square : homes) {
+            int expected = (square & 7) == 4 ? KING : ROOK;
+            if (board[square] != (square < 8 ? expected : -expected)) castling &= ~castlingLostAt(square);
+        }
+
+        // The square a pawn of the side not to move skipped: empty, as is the
+        // one it left, with the pawn in front. Kept only if it can be taken.
+        if (ep != "-") {
+            char rankChar = side == 0 ? '6' : '3';
+            int forward = side == 0 ? -8 : 8; // towards the pawn that moved
+            int square = ep.size() == 2 && ep[0] >= 'a' && ep[0] <= 'h' && ep[1] == rankChar ?
+                (ep[1] - '1') * 8 + (ep[0] - 'a') : -1;
+            if (square < 0 || board[square] || board[square - forward] ||
+                board[square + forward] != (side == 0 ? -PAWN : PAWN)) {
+                clear();
+                return false;
+            }
+            if (pawnAttacks(side ^ 1, square) & pieces(side, PAWN)) enPassant = square;
+        }
+        if (!halfmove.empty()) halfmoveClock = atoi(std::string(halfmove).c_str());
+        if (!fullmove.empty()) fullmoveNumber = atoi(std::string(fullmove).c_str());
+        if (fullmoveNumber < 1) fullmoveNumber = 1;
+
+        if (side) hashKey ^= ZOBRIST.blackToMove;
+        hashKey ^= ZOBRIST.castling[castling];
+        if (enPassant >= 0) hashKey ^= ZOBRIST.enPassant[enPassant & 7];
+        return true;
+    }
+
+    std::string fen() const {
+        std::string out;
+        for (int rank = 7; rank >= 0; --rank) {
+            int empty = 0;
+            for (int file = 0; file < 8; ++file) {
+                int piece = board[rank * 8 + file];
+                if (!piece) {
+                    ++empty;
+                    continue;
+                }
+                if (empty) out += static_cast<char>('0' + empty);
+                empty = 0;
+                char letter = " pnbrqk"[piece > 0 ? piece : -piece];
+                out += piece > 0 ? static_cast<char>(letter - 0x20) : letter;
+            }
+            if (empty) out += static_cast<char>('0' + empty);
+            if (rank) out += '/';
+        }
+        out += side == 0 ? " w " : " b ";
+        if (castling & CASTLE_WHITE_KING) out += 'K';
+        if (castling & CASTLE_WHITE_QUEEN) out += 'Q';
+        if (castling & CASTLE_BLACK_KING) out += 'k';
+        if (castling & CASTLE_BLACK_QUEEN) out += 'q';
+        if (!castling) out += '-';
+        if (enPassant >= 0) {
+            out += ' ';
+            out += static_cast<char>('a' + (enPassant & 7));
+            out += static_cast<char>('1' + (enPassant >> 3));
+        }
+        else {
+            out += " -";
+        }
+        return out + " " + std::to_string(halfmoveClock) + " " + std::to_string(fullmoveNumber);
+    }
+
+    // The game's piece code on a square, 0 for empty.
+    int pieceAt(int square) const {
+        return board[square];
+    }
+
+    bool whiteToMove() const {
+        return side == 0;
+    }
+
+    // Zobrist key of placement, side, castling rights and en passant; the
+    // clocks are left out, so transpositions and repetitions share a key.
+    uint64_t key() const {
+        return hashKey;
+    }
+
+    // Plies since the last capture or pawn move.
+    int halfmoves() const {
+        return halfmoveClock;
+    }
+
+    bool inCheck() const {
+        return attackedBy(side ^ 1, kingSquare(side), occupied());
+    }
+
+    void generateLegalMoves(MoveList& list) const {
+        list.count = 0;
+        int them = side ^ 1;
+        int king = kingSquare(side);
+        Bitboard occupancy = occupied();
+        Bitboard checkers = attackersTo(king, occupancy) & byColor[them];
+
+        // The king is lifted off the board so it cannot hide behind itself
+        // from a slider that checks it.
+        Bitboard kingMoves = kingAttacks(king) & ~byColor[side];
+        Bitboard withoutKing = occupancy ^ squareBit(king);
+        while (kingMoves) {
+            int to = popLowestSquare(kingMoves);
+            if (!attackedBy(them, to, withoutKing)) list.add(makeUciMove(king, to));
+        }
+        if (moreThanOne(checkers)) return;
+
+        Bitboard target = ~byColor[side];
+        if (checkers) target = checkers | betweenSquares(king, lowestSquare(checkers));
+        Bitboard pinned = pinnedPieces(king);
+
+        addPawnMoves(list, king, pinned, target);
+
+        for (int type = KNIGHT; type <= QUEEN; ++type) {
+            Bitboard movers = pieces(side, type);
+            while (movers) {
+                int from = popLowestSquare(movers);
+                Bitboard moves;
+                switch (type) {
+                case KNIGHT: moves = knightAttacks(from); break;
+                case BISHOP: moves = bishopAttacks(from, occupancy); break;
+                case ROOK: moves = rookAttacks(from, occupancy); break;
+                default: moves = bishopAttacks(from, occupancy) | rookAttacks(from, occupancy); break;
+                }
+                moves &= target;
+                if (pinned & squareBit(from)) moves &= lineThrough(king, from);
+                while (moves) list.add(makeUciMove(from, popLowestSquare(moves)));
+            }
+        }
+
+        if (!checkers) addCastling(list);
+    }
+
+    // No sequence of legal moves can mate either side: bare kings, a single
+    // knight or bishop, or only bishops, all on squares of one colour.
+    bool insufficientMaterial() const {
+        if (byType[PAWN] | byType[ROOK] | byType[QUEEN]) return false;
+        Bitboard minors = byType[KNIGHT] | byType[BISHOP];
+        if (!moreThanOne(minors)) return true;
+        const Bitboard DARK_SQUARES = 0xAA55AA55AA55AA55ull;
+        return !byType[KNIGHT] && (!(minors & DARK_SQUARES) || !(minors & ~DARK_SQUARES));
+    }
+
+    // Whether the side to move has lost or the game is drawn, leaving out
+    // repetition, which needs the game's history. Mate and stalemate come
+    // first: they stand even on the move that reaches fifty.
+    GameEnd gameEnd() const {
+        MoveList moves;
+        generateLegalMoves(moves);
+        if (moves.count == 0) return inCheck() ? GameEnd::Checkmate : GameEnd::Stalemate;
+        if (insufficientMaterial()) return GameEnd::InsufficientMaterial;
+        if (halfmoveClock >= 100) return GameEnd::FiftyMoves;
+        return GameEnd::None;
+    }
+
+    bool isLegal(UciMove move) const {
+        if (move == UCI_MOVE_NONE || board[uciMoveFrom(move)] == 0) return false;
+        MoveList list;
+        generateLegalMoves(list);
+        return list.contains(move);
+    }
+
+    // A pawn reaching the last rank, whatever the promotion suffix says.
+    bool isPromotion(UciMove move) const {
+        int piece = board[uciMoveFrom(move)];
+        int rank = uciMoveTo(move) >> 3;
+        return (piece == PAWN && rank == 7) || (piece == -PAWN && rank == 0);
+    }
+
+    bool isCapture(UciMove move) const {
+        int piece = board[uciMoveFrom(move)];
+        return board[uciMoveTo(move)] != 0 ||
+            ((piece == PAWN || piece == -PAWN) && uciMoveTo(move) == enPassant);
+    }
+
+    // Plays a move from generateLegalMoves; anything else corrupts the position.
+    void play(UciMove move) {
+        int from = uciMoveFrom(move), to = uciMoveTo(move);
+        int piece = board[from];
+        int type = piece > 0 ? piece : -piece;
+        bool capture = board[to] != 0;
+
+        if (capture) remove(to);
+        remove(from);
+        if (type == PAWN && to == enPassant) {
+            remove(to + (side == 0 ? -8 : 8));
+            capture = true;
+        }
+        if (type == PAWN && uciMovePromotion(move) != UCI_PROMO_NONE) {
+            int promoted = KNIGHT + uciMovePromotion(move) - UCI_PROMO_KNIGHT;
+            put(to, piece > 0 ? promoted : -promoted);
+        }
+        else {
+            put(to, piece);
+        }
+        if (type == KING && (to - from == 2 || from - to == 2)) {
+            int rookFrom = to > from ? from + 3 : from - 4;
+            int rookTo = to > from ? from + 1 : from - 1;
+            int rook = board[rookFrom];
+            remove(rookFrom);
+            put(rookTo, rook);
+        }
+
+        hashKey ^= ZOBRIST.castling[castling] ^ ZOBRIST.blackToMove;
+        if (enPassant >= 0) hashKey ^= ZOBRIST.enPassant[enPassant & 7];
+        castling &= ~(castlingLostAt(from) | castlingLostAt(to));
+        enPassant = -1;
+        if (type == PAWN && (to - from == 16 || from - to == 16)) {
+            int skipped = (from + to) / 2;
+            if (pawnAttacks(side, skipped) & pieces(side ^ 1, PAWN)) enPassant = skipped;
+        }
+        hashKey ^= ZOBRIST.castling[castling];
+        if (enPassant >= 0) hashKey ^= ZOBRIST.enPassant[enPassant & 7];
+        halfmoveClock = type == PAWN || capture ? 0 : halfmoveClock + 1;
+        if (side == 1) ++fullmoveNumber;
+        side ^= 1;
+    }
+
+    // Plays space-separated UCI moves, checking each. Stops at the first
+    // illegal one and returns false, leaving the moves before it played.
+    bool playMoves(std::string_view moves) {
+        size_t at = 0;
+        while (at < moves.size()) {
+            size_t end = moves.find(' ', at);
+            if (end == std::string_view::npos) end = moves.size();
+            if (end > at) {
+                UciMove move = parseUciMove(moves.substr(at, end - at));
+                if (!isLegal(move)) return false;
+                play(move);
+            }
+            at = end + 1;
+        }
+        return true;
+    }
+
+    // The board as the game draws it: layout[0] is rank 8, layout[y][0] file a.
+    void toLayout(int layout[8][8]) const {
+        for (int y = 0; y < 8; ++y) {
+            for (int x = 0; x < 8; ++x) layout[y][x] = board[(7 - y) * 8 + x];
+        }
+    }
+};
+
+// The keys of the positions a game went through, for the repetition rule.
+// A capture or pawn move can never be undone, so nothing before the last one
+// can repeat: the history is cleared there and stays as short as the
+// halfmove clock.
+class PositionHistory {
+private:
+    std::vector<uint64_t> keys;
+    uint64_t earlier = 0; // sum of every key but the last, for pathKey
+
+public:
+    void reset(const ChessPosition& position) {
+        keys.clear();
+        earlier = 0;
+        keys.push_back(position.key());
+    }
+
+    // Call with the position after every move played.
+    void push(const ChessPosition& position) {
+        if (position.halfmoves() == 0) {
+            keys.clear();
+            earlier = 0;
+        }
+        else if (!keys.empty()) {
+            earlier += keys.back();
+        }
+        keys.push_back(position.key());
+    }
+
+    // Times the current position has stood on the board, itself included.
+    // Only every other ply can match: the side to move is in the key.
+    int occurrences() const {
+        if (keys.empty()) return 0;
+        int count = 1;
+        for (size_t back = 2; back < keys.size(); back += 2) {
+            if (keys[keys.size() - 1 - back] == keys.back()) ++count;
+        }
+        return count;
+    }
+
+    // The current position's key combined with those of the earlier
+    // positions that can still repeat, which the rest of the game depends on.
+    // The earlier keys are summed as they are pushed, so move orders that
+    // pass through the same positions share it and it costs nothing to read.
+    uint64_t pathKey() const {
+        if (keys.empty()) return 0;
+        return keys.back() ^ ((earlier << 1) | (earlier >> 63));
+    }
+
+    // How the game stands after the last move pushed, `position`: the
+    // position's own verdict, or a draw by threefold repetition.
+    GameEnd gameEnd(const ChessPosition& position) const {
+        GameEnd end = position.gameEnd();
+        if (end == GameEnd::None && occurrences() >= 3) return GameEnd::Repetition;
+        return end;
+    }
+};
@@ -1,118 +1,542 @@
 // engine.hpp
 #pragma once
-#include <windows.h>
+#include "engine_backend.hpp"
+#include "engine_reaper.hpp"
+#include "uci_line_queue.hpp"
+#include "uci_command_batch.hpp"
+#include "uci_parser.hpp"
+#include "search_limits.hpp"
+#include "bot_difficulty.hpp"
+#include "engine_metrics.hpp"
+#include "engine_resources.hpp"
+#include "engine_result_cache.hpp"
 #include <string>
+#include <string_view>
 #include <iostream>
 #include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+const wchar_t ENGINE_PATH[] = L"stockfish.exe";
+#else
+const wchar_t ENGINE_PATH[] = L"stockfish";
+#endif
+
+// $VIBE_CHESS_ENGINE when set, e.g. to run against tools/mock_engine
+// without Stockfish installed; ENGINE_PATH otherwise.
+inline std::wstring defaultEnginePath() {
+#ifdef _WIN32
+    wchar_t* value = nullptr;
+    size_t size = 0;
+    if (_wdupenv_s(&value, &size, L"VIBE_CHESS_ENGINE") == 0 && value) {
+        std::wstring path(value);
+        free(value);
+        if (!path.empty()) return path;
+    }
+#else
+    const char* value = getenv("VIBE_CHESS_ENGINE");
+    if (value && *value) {
+        std::wstring path(strlen(value) + 1, L'\0');
+        size_t len = std::mbstowcs(&path[0], value, path.size());
+        if (len != static_cast<size_t>(-1)) {
+            path.resize(len);
+            return path;
+        }
+    }
+#endif
+    return ENGINE_PATH;
+}
+
+class BestMoveFuture;
+
+// An option the engine advertised in its uci handshake.
+struct EngineOption {
+    std::string type;
+    std::string defaultValue;
+    int64_t min = 0;
+    int64_t max = 0;
+    bool hasRange = false;
+};
+
+struct PonderStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t savedMs = 0; // time already searched when a ponderhit arrived
+
+    double hitRate() const {
+        return hits + misses == 0 ? 0.0 : static_cast<double>(hits) / (hits + misses);
+    }
+};
+
+// What we have written to one engine, so position traffic can be checked to
+// stay flat as games get longer.
+struct EngineTraffic {
+    uint64_t bytesWritten = 0;
+    uint64_t commandsWritten = 0;
+    uint64_t writeCalls = 0;         // backend writes, i.e. syscalls for a spawned engine
+    uint64_t positionsSent = 0;
+    uint64_t positionsSkipped = 0;   // syncPosition calls the engine already knew
+    std::vector<uint32_t> bytesPerPly; // bytes written while each finished ply was current
+};
 
 class ChessEngine {
 private:
-    HANDLE hChildStd_IN_Rd = NULL;
-    HANDLE hChildStd_IN_Wr = NULL;
-    HANDLE hChildStd_OUT_Rd = NULL;
-    HANDLE hChildStd_OUT_Wr = NULL;
-    PROCESS_INFORMATION piProcInfo;
+    std::unique_ptr<EngineBackend> backend;
+    DirectEngine* direct = nullptr; // backend->direct(), searches skip UCI text when set
     bool engineReady = false;
-    int difficultyLevel;
+    int difficultyLevel = -1; // -1 until setDifficulty; also the metrics bucket
+    int multiPv = 1;
+    std::string engineName; // from "id name", part of every result cache key
+    std::map<std::string, EngineOption> options;
+    std::map<std::string, std::string> optionValues; // what each option was last set to
+    std::unique_ptr<UciLineQueue> lines{ new UciLineQueue() }; // handed to EngineReaper with the backend
+    UciCommandBatch outgoing;
+    int batchDepth = 0; // open CommandBatch scopes; writes wait until it is 0
+    unsigned searchId = 0;
+    bool searching = false;
+    bool stopSent = false;
+    std::chrono::steady_clock::time_point searchDeadline; // only meaningful with a latency budget
+    bool hasSearchDeadline = false;
+    bool pondering = false;
+    bool ponderOptionSent = false;
+    std::string ponderMove;
+    SearchLimits ponderLimits;
+    std::chrono::steady_clock::time_point ponderStart;
+    PonderStats ponderCounters;
+    int staleSearches = 0; // stopped searches whose bestmove is still on its way
+    std::string knownPosition; // last position command the engine received
+    int knownPly = -1;
+    uint64_t plyStartBytes = 0;
+    EngineTraffic trafficStats;
+    std::chrono::steady_clock::time_point isreadySentAt;
+    bool isreadyPending = false;
+    std::chrono::steady_clock::time_point searchStartedAt;
+    uint64_t searchBytesIn = 0;
+    uint64_t searchNodes = 0;
+    uint64_t searchNps = 0;
+    uint64_t writeCallsAtBestMove = 0;
+    EngineResultCache* resultCache = nullptr;
+    EngineResources resources;  // what applyResources last set
+    uint64_t searchCacheKey = 0; // where the running search's bestmove is stored, 0 for nowhere
+    UciScore searchScore;
+
+    static int countMoves(const std::string& moves) {
+        if (moves.empty()) return 0;
+        int count = 1;
+        for (char c : moves) {
+            if (c == ' ') ++count;
+        }
+        return count;
+    }
+
+    // fen is empty for the start position.
+    void syncPositionCommand(const std::string& fen, const std::string& moves, int ply) {
+        std::string command = fen.empty() ? "position startpos" : "position fen " + fen;
+        if (!moves.empty()) command += " moves " + moves;
+        if (ply != knownPly) {
+            if (knownPly >= 0) {
+                trafficStats.bytesPerPly.push_back(static_cast<uint32_t>(trafficStats.bytesWritten - plyStartBytes));
+            }
+            plyStartBytes = trafficStats.bytesWritten;
+            knownPly = ply;
+        }
+
+        if (command == knownPosition) {
+            ++trafficStats.positionsSkipped;
+            return;
+        }
+        if (!direct) {
+            SendCommand(command);
+            return;
+        }
+        flushCommands();
+        direct->setPosition(fen, moves);
+        knownPosition = command;
+        ++trafficStats.positionsSent;
+    }
+
+    // The search commands, as calls when the backend takes them directly.
+    // Text still waiting in a batch goes first, so the order holds.
+    void sendGo(const SearchLimits& limits, bool ponder = false) {
+        if (!direct) {
+            SendCommand(limits.goCommand(ponder));
+            return;
+        }
+        flushCommands();
+        direct->search(limits, ponder);
+    }
+
+    void sendStop() {
+        if (!direct) {
+            SendCommand("stop");
+            return;
+        }
+        flushCommands();
+        direct->stop();
+    }
+
+    void armSearchDeadline(const SearchLimits& limits) {
+        hasSearchDeadline = limits.latencyBudgetMs() > 0;
+        if (hasSearchDeadline) {
+            searchDeadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(limits.latencyBudgetMs());
+        }
+    }
+
+    // Queues a setoption unless the engine already has that value.
+    template <typename Value>
+    void sendOption(const std::string& name, const Value& value, const std::string& text) {
+        if (!engineReady) return;
+        auto it = optionValues.find(name);
+        if (it != optionValues.end() && it->second == text) return;
+        noteCommand("setoption", outgoing.setOption(name, value));
+        optionValues[name] = text;
+    }
+
+    // Bookkeeping for a command just added to `outgoing`.
+    void noteCommand(std::string_view command, size_t bytes) {
+        trafficStats.bytesWritten += bytes;
+        ++trafficStats.commandsWritten;
+        EngineMetrics::instance().record(difficultyLevel, METRIC_BYTES_OUT, bytes);
+        if (command == "isready") {
+            isreadySentAt = std::chrono::steady_clock::now();
+            isreadyPending = true;
+        }
+        if (command.compare(0, 9, "position ") == 0) {
+            knownPosition.assign(command.data(), command.size());
+            ++trafficStats.positionsSent;
+        }
+    }
+
+    void flushCommands() {
+        if (outgoing.empty()) return;
+        if (engineReady) {
+            backend->write(outgoing.data(), outgoing.size());
+            ++trafficStats.writeCalls;
+        }
+        outgoing.clear();
+    }
+
+    static uint64_t microsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void startSearchClock() {
+        searchStartedAt = std::chrono::steady_clock::now();
+        searchBytesIn = 0;
+        searchNodes = 0;
+        searchNps = 0;
+        searchScore = UciScore();
+    }
+
+    uint64_t resultCacheKey(const std::string& position, const SearchLimits& limits) const {
+        if (!resultCache || multiPv != 1) return 0;
+        return EngineResultCache::makeKey(engineName, position, limits, difficultyLevel);
+    }
+    uint64_t resultCacheKey(const ResultCachePosition& at, const SearchLimits& limits) const {
+        if (!resultCache || multiPv != 1) return 0;
+        return EngineResultCache::makeKey(engineName, at, limits, difficultyLevel);
+    }
+
+    // Records the search that just ended and hands out its result, whether
+    // the bestmove came as a line or straight from a DirectEngine.
+    void finishSearch(const UciBestMove& best, std::string& bestMove, std::string& ponder) {
+        searching = false;
+        EngineMetrics& metrics = EngineMetrics::instance();
+        metrics.record(difficultyLevel, METRIC_SEARCH_US, microsSince(searchStartedAt));
+        if (searchNodes) metrics.record(difficultyLevel, METRIC_SEARCH_NODES, searchNodes);
+        if (searchNps) metrics.record(difficultyLevel, METRIC_SEARCH_NPS, searchNps);
+        metrics.record(difficultyLevel, METRIC_BYTES_IN, searchBytesIn);
+        metrics.record(difficultyLevel, METRIC_WRITES, trafficStats.writeCalls - writeCallsAtBestMove);
+        writeCallsAtBestMove = trafficStats.writeCalls;
+        // A search cut short by its deadline is not what the limits ask for.
+        if (searchCacheKey && !stopSent && resultCache) {
+            CachedResult result;
+            result.move = best.move;
+            result.ponder = best.ponder;
+            result.score = searchScore;
+            resultCache->store(searchCacheKey, result);
+        }
+        bestMove = uciMoveToString(best.move);
+        ponder = uciMoveToString(best.ponder);
+    }
+
+    // startSearch and startPonder once the result cache key is known;
+    // `cacheKey` is where the bestmove is stored, 0 for nowhere.
+    unsigned beginSearch(const std::string& position, const SearchLimits& limits, uint64_t cacheKey) {
+        CommandBatch batch(*this);
+        if (searching) stopSearch(searchId);
+
+        syncPosition(position);
+        sendGo(limits);
+        searching = true;
+        stopSent = false;
+        armSearchDeadline(limits);
+        startSearchClock();
+        searchCacheKey = cacheKey;
+        return ++searchId;
+    }
+
+    void beginPonder(const std::string& position, const std::string& expectedMove, const SearchLimits& limits,
+        uint64_t cacheKey) {
+        CommandBatch batch(*this);
+        if (searching) stopSearch(searchId);
+
+        if (!ponderOptionSent) {
+            SendCommand("setoption name Ponder value true");
+            ponderOptionSent = true;
+        }
+
+        syncPosition(position.empty() ? expectedMove : position + " " + expectedMove);
+        sendGo(limits, true);
+        searching = true;
+        stopSent = false;
+        hasSearchDeadline = false;
+        pondering = true;
+        ponderMove = expectedMove;
+        ponderLimits = limits;
+        ponderStart = std::chrono::steady_clock::now();
+        startSearchClock();
+        searchCacheKey = cacheKey;
+        ++searchId;
+    }
+
+    BestMoveFuture bestMoveAsync(const std::string& position, const SearchLimits& limits, uint64_t cacheKey);
+
+    // Times isready round trips for every reader of the line queue.
+    void observeLine(const std::string& line) {
+        if (isreadyPending && line.compare(0, 7, "readyok") == 0) {
+            isreadyPending = false;
+            EngineMetrics::instance().record(difficultyLevel, METRIC_ISREADY_US, microsSince(isreadySentAt));
+        }
+    }
+
+    // Swallows the bestmove of a search nobody waits for any more.
+    bool isStaleBestMove(const std::string& line) {
+        if (staleSearches == 0 || line.compare(0, 8, "bestmove") != 0) return false;
+        --staleSearches;
+        return true;
+    }
 
 public:
     ChessEngine() = default;
+    ChessEngine(const ChessEngine&) = delete;
+    ChessEngine& operator=(const ChessEngine&) = delete;
 
     ~ChessEngine() {
         CloseConnection();
     }
 
-    bool ConnectToEngine(const std::wstring& enginePath = L"stockfish.exe") {
-        SECURITY_ATTRIBUTES saAttr = { sizeof(SECURITY_ATTRIBUTES) };
-        saAttr.bInheritHandle = TRUE;
-        saAttr.lpSecurityDescriptor = NULL;
-
-        if (!CreatePipe(&hChildStd_OUT_Rd, &hChildStd_OUT_Wr, &saAttr, 0) ||
-            !CreatePipe(&hChildStd_IN_Rd, &hChildStd_IN_Wr, &saAttr, 0)) {
-            std::cerr << "CreatePipe failed: " << GetLastError() << std::endl;
-            return false;
-        }
-
-        STARTUPINFOW siStartInfo = { sizeof(STARTUPINFOW) };
-        siStartInfo.hStdError = hChildStd_OUT_Wr;
-        siStartInfo.hStdOutput = hChildStd_OUT_Wr;
-        siStartInfo.hStdInput = hChildStd_IN_Rd;
-        siStartInfo.dwFlags |= STARTF_USESTDHANDLES;
-
-        std::wstring cmdLine = L"\"" + enginePath + L"\"";
-        if (!CreateProcessW(
-            NULL,
-            &cmdLine[0],
-            NULL,
-            NULL,
-            TRUE,
-            CREATE_NO_WINDOW,
-            NULL,
-            NULL,
-            &siStartInfo,
-            &piProcInfo)) {
-            std::cerr << "CreateProcess failed: " << GetLastError() << std::endl;
+    bool ConnectToEngine(const std::wstring& enginePath = defaultEnginePath()) {
+        auto spawnedAt = std::chrono::steady_clock::now();
+        CloseConnection();
+        lines.reset(new UciLineQueue());
+        lines->reset();
+        backend = makeEngineBackend(enginePath);
+        if (!backend->start(enginePath, *lines)) {
+            backend.reset();
             return false;
         }
-
-        CloseHandle(hChildStd_OUT_Wr);
-        CloseHandle(hChildStd_IN_Rd);
+        direct = backend->direct();
+        knownPosition.clear();
 
         engineReady = true;
 
         // Initialize Stockfish
-        SendCommand("uci");
-        SendCommand("isready");
-
-        std::string ready;
-        auto start = std::chrono::steady_clock::now();
-        while (std::chrono::duration_cast<std::chrono::milliseconds>(
-            std::chrono::steady_clock::now() - start).count() < 5000) {
-            ready = GetResponse(100);
-            if (ready.find("readyok") != std::string::npos) {
-                break;
-            }
+        {
+            CommandBatch batch(*this);
+            SendCommand("uci");
+            SendCommand("isready");
         }
+        isreadyPending = false; // counted as the handshake instead
 
+        std::string ready = GetResponse(5000);
         if (ready.find("readyok") == std::string::npos) {
             std::cerr << "Stockfish initialization failed!" << std::endl;
             return false;
         }
 
+        options.clear();
+        optionValues.clear();
+        engineName.clear();
+        size_t start = 0;
+        while (start < ready.size()) {
+            size_t end = ready.find('\n', start);
+            if (ready.compare(start, 8, "id name ") == 0) {
+                engineName = ready.substr(start + 8, end - start - 8);
+            }
+            UciOption option;
+            if (parseUciOption(std::string_view(ready).substr(start, end - start), option)) {
+                EngineOption& entry = options[std::string(option.name)];
+                entry.type = std::string(option.type);
+                entry.defaultValue = std::string(option.defaultValue);
+                entry.min = option.min;
+                entry.max = option.max;
+                entry.hasRange = option.hasRange;
+            }
+            start = end + 1;
+        }
+        EngineMetrics::instance().record(difficultyLevel, METRIC_HANDSHAKE_US, microsSince(spawnedAt));
+
         return true;
     }
+    // Applies botDifficulty(level). UCI_Elo is only used by engines that
+    // have it; the rest get Skill Level alone. Options already in effect
+    // are not sent again.
     void setDifficulty(int level) {
+        BotDifficulty difficulty = botDifficulty(level);
+        CommandBatch batch(*this);
         difficultyLevel = level;
+        setOption("Skill Level", level);
+        if (hasOption("UCI_LimitStrength")) {
+            bool limited = difficulty.elo > 0 && hasOption("UCI_Elo");
+            const char* value = limited ? "true" : "false";
+            sendOption("UCI_LimitStrength", std::string_view(value), value);
+            if (limited) setOption("UCI_Elo", difficulty.elo);
+        }
+    }
+
+    // Options from the handshake, by name as the engine spelled it.
+    const std::map<std::string, EngineOption>& engineOptions() const {
+        return options;
+    }
 
-        SendCommand("setoption name Skill Level value " + std::to_string(difficultyLevel));
+    bool hasOption(const std::string& name) const {
+        return options.count(name) != 0;
+    }
 
+    // Answers repeated searches from `cache` before asking the engine, and
+    // stores every bestmove it produces there. nullptr turns that off.
+    void setResultCache(EngineResultCache* cache) {
+        resultCache = cache;
     }
-    void SendCommand(const std::string& command) {
+
+    // Sets an advertised spin option, clamped to its range; nothing is sent
+    // if it already has that value. Returns the value now in effect, or -1
+    // if the engine has no such option.
+    int64_t setOption(const std::string& name, int64_t value) {
+        auto it = options.find(name);
+        if (it == options.end()) return -1;
+        if (it->second.hasRange) {
+            if (value < it->second.min) value = it->second.min;
+            if (value > it->second.max) value = it->second.max;
+        }
+        sendOption(name, value, std::to_string(value));
+        if (batchDepth == 0) flushCommands();
+        return value;
+    }
+
+    // Sizes Threads and Hash from the plan and waits for the engine to
+    // allocate them. Logs what was actually set.
+    bool applyResources(const EngineResources& plan, int timeoutMs = 10000) {
+        CommandBatch batch(*this);
+        int64_t threads = setOption("Threads", plan.threads);
+        int64_t hash = setOption("Hash", plan.hashMb);
+
+        EngineResources chosen = plan;
+        chosen.threads = static_cast<int>(threads);
+        chosen.hashMb = hash;
+        std::cout << "Engine options: " << chosen.describe() << std::endl;
+        resources = chosen;
+
+        SendCommand("isready");
+        return GetResponse(timeoutMs).find("readyok") != std::string::npos;
+    }
+    const EngineResources& appliedResources() const {
+        return resources;
+    }
+
+    // Number of principal variations each search reports; 1 is the engine default.
+    void setMultiPv(int lines) {
+        if (lines < 1) lines = 1;
+        if (lines == multiPv) return;
+        setOption("MultiPV", lines);
+        multiPv = lines;
+    }
+
+    // Keeps this engine's commands in one buffer while it lives and writes
+    // them with a single call when the outermost batch ends, so sequences
+    // like position + go cost one syscall and one engine wakeup. Reading a
+    // response flushes early, so waiting inside a batch cannot deadlock.
+    class CommandBatch {
+    private:
+        ChessEngine& engine;
+
+    public:
+        explicit CommandBatch(ChessEngine& engine) : engine(engine) {
+            ++engine.batchDepth;
+        }
+        ~CommandBatch() {
+            if (--engine.batchDepth == 0) engine.flushCommands();
+        }
+        CommandBatch(const CommandBatch&) = delete;
+        CommandBatch& operator=(const CommandBatch&) = delete;
+    };
+
+    void SendCommand(std::string_view command) {
         if (!engineReady) return;
 
-        std::string cmd = command + "\n";
-        DWORD dwWritten;
-        WriteFile(hChildStd_IN_Wr, cmd.c_str(), cmd.size(), &dwWritten, NULL);
+        noteCommand(command, outgoing.add(command));
+        if (batchDepth == 0) flushCommands();
+    }
+
+    // Makes startpos + moves the engine's current position, writing nothing
+    // when that is already what it has.
+    void syncPosition(const std::string& moves) {
+        syncPositionCommand("", moves, countMoves(moves));
+    }
+
+    // Same, from a FEN snapshot plus the moves played since it, so the command
+    // stays short however long the game gets. ply is the game ply it reaches.
+    void syncPosition(const std::string& fen, const std::string& moves, int ply) {
+        syncPositionCommand(fen, moves, ply);
+    }
+
+    const EngineTraffic& traffic() const {
+        return trafficStats;
+    }
+
+    // Pops the next complete engine line, waiting at most timeoutMs for it.
+    bool ReadLine(std::string& line, int timeoutMs) {
+        flushCommands();
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        while (lines->popUntil(line, deadline)) {
+            if (isStaleBestMove(line)) continue;
+            observeLine(line);
+            return true;
+        }
+        return false;
+    }
+
+    // Never blocks; meant for callers polling once per frame.
+    bool TryReadLine(std::string& line) {
+        while (lines->tryPop(line)) {
+            if (isStaleBestMove(line)) continue;
+            observeLine(line);
+            return true;
+        }
+        return false;
     }
 
     std::string GetResponse(int timeoutMs = 5000) {
-        const int BUFSIZE = 4096;
-        CHAR chBuf[BUFSIZE];
-        DWORD dwRead;
         std::string response;
+        std::string line;
+        flushCommands();
 
-        auto start = std::chrono::steady_clock::now();
-        while (std::chrono::duration_cast<std::chrono::milliseconds>(
-            std::chrono::steady_clock::now() - start).count() < timeoutMs) {
-            if (!ReadFile(hChildStd_OUT_Rd, chBuf, BUFSIZE - 1, &dwRead, NULL) || dwRead == 0) {
-                continue;
-            }
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        while (lines->popUntil(line, deadline)) {
+            if (isStaleBestMove(line)) continue;
+            observeLine(line);
 
-            chBuf[dwRead] = '\0';
-            response += chBuf;
+            response += line;
+            response += '\n';
 
-            if (response.find("readyok") != std::string::npos ||
-                response.find("bestmove") != std::string::npos) {
+            if (line.compare(0, 7, "readyok") == 0 ||
+                line.compare(0, 8, "bestmove") == 0) {
                 break;
             }
         }
@@ -120,46 +544,187 @@ public:
         return response;
     }
 
+    // Waits up to ten seconds for the search; empty if it did not finish.
     std::string getBestMove(const std::string& position, int depth = 15) {
         if (!engineReady) return "";
 
-        SendCommand("position startpos moves " + position);
-        SendCommand("go depth " + std::to_string(depth));
-        std::string response = GetResponse(10000);
-
-        size_t pos = response.find("bestmove ");
-        if (pos != std::string::npos) {
-            std::string move = response.substr(pos + 9, 4);
-            if (move.length() == 4 &&
-                isalpha(move[0]) && isdigit(move[1]) &&
-                isalpha(move[2]) && isdigit(move[3])) {
-                return move;
+        unsigned id = startSearch(position, depth);
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        std::string best, ponder;
+        while (!pollSearch(id, best, ponder)) {
+            if (std::chrono::steady_clock::now() >= deadline) {
+                stopSearch(id);
+                return "";
             }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
         }
-        return "";
+        return best;
     }
 
+    // Starts a search and returns immediately; the result is collected with
+    // pollSearch, so the caller's frame loop never waits on the engine.
+    // A game passes `at`, where it stands, so the result cache need not
+    // replay `position` to key the bestmove.
+    unsigned startSearch(const std::string& position, const SearchLimits& limits) {
+        return beginSearch(position, limits, resultCacheKey(position, limits));
+    }
+    unsigned startSearch(const std::string& position, const SearchLimits& limits, const ResultCachePosition& at) {
+        return beginSearch(position, limits, resultCacheKey(at, limits));
+    }
 
-    void CloseConnection() {
-        engineReady = false;
+    // Thinks on the position after the expected reply `expectedMove` while the
+    // player is still on move. Resolve it with resolvePonder once they move.
+    // `after` is where the game stands once expectedMove is played.
+    void startPonder(const std::string& position, const std::string& expectedMove, const SearchLimits& limits) {
+        if (expectedMove.empty()) return;
+        std::string pondered = position.empty() ? expectedMove : position + " " + expectedMove;
+        beginPonder(position, expectedMove, limits, resultCacheKey(pondered, limits));
+    }
+    void startPonder(const std::string& position, const std::string& expectedMove, const SearchLimits& limits,
+        const ResultCachePosition& after) {
+        if (!expectedMove.empty()) beginPonder(position, expectedMove, limits, resultCacheKey(after, limits));
+    }
 
-        if (hChildStd_IN_Wr) {
-            SendCommand("quit");
-            CloseHandle(hChildStd_IN_Wr);
-            hChildStd_IN_Wr = NULL;
+    // Abandons a ponder search that will never be resolved, as when the game
+    // ends while the player is on move.
+    void stopPonder() {
+        if (pondering) stopSearch(searchId);
+    }
+
+    bool isPondering() const {
+        return pondering;
+    }
+
+    const PonderStats& ponderStats() const {
+        return ponderCounters;
+    }
+
+    BestMoveFuture resolvePonder(const std::string& playedMove);
+
+    unsigned startSearch(const std::string& position, int depth) {
+        return startSearch(position, SearchLimits::fixedDepth(depth));
+    }
+
+    // Returns true once search `id` has produced its bestmove (empty if the
+    // engine had no legal move or died).
+    bool pollSearch(unsigned id, std::string& bestMove, std::string& ponder) {
+        return pollSearch(id, bestMove, ponder, [](const UciInfo&) {});
+    }
+
+    // Same, handing every info line of the search to onInfo as it is drained.
+    // The UciInfo is only valid during the call.
+    template <typename OnInfo>
+    bool pollSearch(unsigned id, std::string& bestMove, std::string& ponder, OnInfo&& onInfo) {
+        if (id != searchId || !searching) return false;
+
+        std::string line;
+        UciInfo info;
+        while (lines->tryPop(line)) {
+            if (isStaleBestMove(line)) continue;
+            observeLine(line);
+            searchBytesIn += line.size() + 1;
+            if (parseUciInfo(line, info)) {
+                if (info.nodes) searchNodes = info.nodes;
+                if (info.nps) searchNps = info.nps;
+                if (info.multipv == 1 && info.score.kind != UciScore::None) searchScore = info.score;
+                onInfo(info);
+                continue;
+            }
+            if (line.compare(0, 8, "bestmove") == 0) {
+                UciBestMove best;
+                parseUciBestMove(line, best);
+                finishSearch(best, bestMove, ponder);
+                return true;
+            }
+        }
+        if (direct) {
+            UciBestMove best;
+            while (direct->takeBestMove(best)) {
+                if (staleSearches > 0) {
+                    --staleSearches;
+                    continue;
+                }
+                finishSearch(best, bestMove, ponder);
+                return true;
+            }
         }
 
-        if (hChildStd_OUT_Rd) {
-            CloseHandle(hChildStd_OUT_Rd);
-            hChildStd_OUT_Rd = NULL;
+        if (lines->isClosed()) {
+            searching = false;
+            bestMove.clear();
+            ponder.clear();
+            return true;
         }
 
-        if (piProcInfo.hProcess) {
-            WaitForSingleObject(piProcInfo.hProcess, 1000);
-            CloseHandle(piProcInfo.hProcess);
-            CloseHandle(piProcInfo.hThread);
-            piProcInfo.hProcess = NULL;
-            piProcInfo.hThread = NULL;
+        // Over budget: ask for the best move found so far.
+        if (hasSearchDeadline && !stopSent && std::chrono::steady_clock::now() >= searchDeadline) {
+            sendStop();
+            stopSent = true;
+        }
+        return false;
+    }
+
+    void stopSearch(unsigned id) {
+        if (id != searchId || !searching) return;
+
+        sendStop();
+        searching = false;
+        pondering = false;
+        ++staleSearches;
+    }
+
+    bool isSearching() const {
+        return searching;
+    }
+
+    // The bestmove from the result cache if it has one, else a search. A game
+    // passes `at`, where it stands, so the lookup need not replay `position`.
+    BestMoveFuture getBestMoveAsync(const std::string& position, const SearchLimits& limits);
+    BestMoveFuture getBestMoveAsync(const std::string& position, const SearchLimits& limits, const ResultCachePosition& at);
+    BestMoveFuture getBestMoveAsync(const std::string& position, int depth = 15);
+
+    // Abandons any running search and tells the engine a new game starts.
+    void newGame() {
+        CommandBatch batch(*this);
+        if (searching) stopSearch(searchId);
+        SendCommand("ucinewgame");
+        knownPosition.clear();
+        knownPly = -1;
+    }
+
+    // newGame plus a readyok round trip; false if the engine stopped answering.
+    // The engine is put back to full strength, so a pooled one never passes
+    // its last lease's handicap on; its metrics go to no level until the
+    // next setDifficulty.
+    bool resetForNewGame(int timeoutMs = 5000) {
+        CommandBatch batch(*this);
+        newGame();
+        setMultiPv(1);
+        setDifficulty(20);
+        difficultyLevel = -1;
+        SendCommand("isready");
+        return GetResponse(timeoutMs).find("readyok") != std::string::npos;
+    }
+
+    // Returns at once: a running search is stopped first, then the engine
+    // is asked to quit and left to EngineReaper, which kills it if it is
+    // still there after graceMs.
+    void CloseConnection(int graceMs = 1000) {
+        // A plugin's search is stopped by its destroy(), off this thread.
+        if (engineReady && !direct) {
+            CommandBatch batch(*this);
+            if (searching) SendCommand("stop");
+            SendCommand("quit");
+        }
+        direct = nullptr;
+        engineReady = false;
+        searching = false;
+        pondering = false;
+        staleSearches = 0;
+        outgoing.clear();
+        if (backend) {
+            EngineReaper::instance().reap(std::move(backend), std::move(lines), graceMs);
+            lines.reset(new UciLineQueue());
         }
     }
 
@@ -171,4 +736,101 @@ public:
             std::cerr << "Error while closing engine" << std::endl;
         }
     }
-};
\ No newline at end of file
+};
+
+// Future-like handle for ChessEngine::startSearch. Poll ready() once per
+// frame; stop() cancels the search and discards its result.
+class BestMoveFuture {
+private:
+    ChessEngine* engine = nullptr;
+    unsigned id = 0;
+    bool done = false;
+    std::string move;
+    std::string ponderMove;
+
+public:
+    BestMoveFuture() = default;
+    BestMoveFuture(ChessEngine& engine, unsigned id) : engine(&engine), id(id) {}
+
+    // Already finished, for a result that needed no search.
+    BestMoveFuture(ChessEngine& engine, const std::string& move, const std::string& ponder)
+        : engine(&engine), done(true), move(move), ponderMove(ponder) {}
+
+    bool valid() const {
+        return engine != nullptr;
+    }
+
+    bool ready() {
+        if (!done && engine) done = engine->pollSearch(id, move, ponderMove);
+        return done;
+    }
+
+    const std::string& get() const {
+        return move;
+    }
+
+    // The reply the engine expects, empty if it did not name one.
+    const std::string& ponder() const {
+        return ponderMove;
+    }
+
+    void stop() {
+        if (engine && !done) engine->stopSearch(id);
+        engine = nullptr;
+        done = false;
+        move.clear();
+        ponderMove.clear();
+    }
+};
+
+inline BestMoveFuture ChessEngine::bestMoveAsync(const std::string& position, const SearchLimits& limits,
+    uint64_t cacheKey) {
+    CachedResult cached;
+    if (cacheKey && resultCache->lookup(cacheKey, cached)) {
+        if (searching) stopSearch(searchId);
+        return BestMoveFuture(*this, uciMoveToString(cached.move), uciMoveToString(cached.ponder));
+    }
+
+    unsigned id = beginSearch(position, limits, cacheKey);
+    return BestMoveFuture(*this, id);
+}
+
+inline BestMoveFuture ChessEngine::getBestMoveAsync(const std::string& position, const SearchLimits& limits) {
+    return bestMoveAsync(position, limits, resultCacheKey(position, limits));
+}
+
+inline BestMoveFuture ChessEngine::getBestMoveAsync(const std::string& position, const SearchLimits& limits,
+    const ResultCachePosition& at) {
+    return bestMoveAsync(position, limits, resultCacheKey(at, limits));
+}
+
+// On a ponder hit the running search carries on as the real one and its
+// future is returned; on a miss it is stopped and the future is invalid.
+inline BestMoveFuture ChessEngine::resolvePonder(const std::string& playedMove) {
+    if (!pondering) return BestMoveFuture();
+
+    if (playedMove != ponderMove) {
+        stopSearch(searchId);
+        ++ponderCounters.misses;
+        return BestMoveFuture();
+    }
+
+    if (direct) {
+        flushCommands();
+        direct->ponderhit();
+    }
+    else {
+        SendCommand("ponderhit");
+    }
+    pondering = false;
+    armSearchDeadline(ponderLimits);
+    searchStartedAt = std::chrono::steady_clock::now(); // the player only waits from here
+    ++ponderCounters.hits;
+    ponderCounters.savedMs += std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - ponderStart).count();
+    return BestMoveFuture(*this, searchId);
+}
+
+inline BestMoveFuture ChessEngine::getBestMoveAsync(const std::string& position, int depth) {
+    return getBestMoveAsync(position, SearchLimits::fixedDepth(depth));
+}
@@ -0,0 +1,122 @@
+// engine_analysis.hpp
+#pragma once
+#include "engine_pool.hpp"
+#include "search_limits.hpp"
+#include "uci_parser.hpp"
+#include <memory>
+#include <string>
+
+const int ANALYSIS_MAX_LINES = 8;
+
+// Top-N lines of the running analysis, best first. lines[i] is the latest
+// "info multipv i+1" that carried a pv.
+struct AnalysisSnapshot {
+    unsigned version = 0; // bumped whenever anything below changes
+    int lineCount = 0;
+    UciInfo lines[ANALYSIS_MAX_LINES];
+    bool finished = false; // the search ended (limit reached or stopped by the engine)
+    UciMove bestMove = UCI_MOVE_NONE;
+};
+
+// MultiPV analysis on its own pooled engine, so it never takes search time
+// from the bot's engine. Driven from the frame loop like BestMoveFuture:
+// start() once, poll() every frame, then read snapshot(). Info lines are
+// parsed straight out of the engine's line queue into the snapshot the UI
+// reads, so an update is never copied or handed between threads.
+class EngineAnalysis {
+private:
+    std::unique_ptr<EngineLease> lease; // taken on first use, never blocks the frame
+    bool wanted = false;                // start() was called and not yet sent
+    bool running = false;
+    unsigned searchId = 0;
+    std::string position;
+    int multiPv = 1;
+    SearchLimits limits = SearchLimits::infinite();
+    AnalysisSnapshot current;
+
+    bool ensureEngine() {
+        if (lease) return true;
+        std::unique_ptr<ChessEngine> engine = EnginePool::instance().acquire(0);
+        if (!engine) return false;
+        lease.reset(new EngineLease(std::move(engine)));
+        (*lease)->setDifficulty(20); // already full strength; names the metrics level
+        return true;
+    }
+
+    void launch() {
+        ChessEngine& engine = **lease;
+        engine.setMultiPv(multiPv);
+        searchId = engine.startSearch(position, limits);
+        wanted = false;
+        running = true;
+    }
+
+    void onInfo(const UciInfo& info) {
+        if (info.pvLength == 0 || info.multipv < 1 || info.multipv > multiPv) return;
+
+        UciInfo& line = current.lines[info.multipv - 1];
+        line = info;
+        line.text = std::string_view();
+        if (info.multipv > current.lineCount) current.lineCount = info.multipv;
+        ++current.version;
+    }
+
+public:
+    EngineAnalysis() = default;
+    EngineAnalysis(const EngineAnalysis&) = delete;
+    EngineAnalysis& operator=(const EngineAnalysis&) = delete;
+
+    ~EngineAnalysis() {
+        stop();
+    }
+
+    // Analyses startpos + moves, reporting up to `lines` variations. Replaces
+    // any analysis already running. If no engine is idle yet, the search
+    // starts from a later poll() once the pool has one.
+    void start(const std::string& moves, int lines = 3,
+        const SearchLimits& searchLimits = SearchLimits::infinite()) {
+        stop();
+        position = moves;
+        multiPv = lines < 1 ? 1 : lines > ANALYSIS_MAX_LINES ? ANALYSIS_MAX_LINES : lines;
+        limits = searchLimits;
+        current.lineCount = 0;
+        current.finished = false;
+        current.bestMove = UCI_MOVE_NONE;
+        ++current.version;
+        wanted = true;
+        if (ensureEngine()) launch();
+    }
+
+    // Drains whatever the engine has printed since the last call. Returns
+    // true if the snapshot changed.
+    bool poll() {
+        if (wanted && ensureEngine()) launch();
+        if (!running) return false;
+
+        unsigned before = current.version;
+        std::string bestMove, ponder;
+        if ((*lease)->pollSearch(searchId, bestMove, ponder,
+            [this](const UciInfo& info) { onInfo(info); })) {
+            running = false;
+            current.finished = true;
+            current.bestMove = parseUciMove(bestMove);
+            ++current.version;
+        }
+        return current.version != before;
+    }
+
+    void stop() {
+        wanted = false;
+        if (!running) return;
+        (*lease)->stopSearch(searchId);
+        running = false;
+    }
+
+    bool isRunning() const {
+        return running || wanted;
+    }
+
+    const AnalysisSnapshot& snapshot() const {
+        return current;
+    }
+};
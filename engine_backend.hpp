@@ -0,0 +1,681 @@
+// engine_backend.hpp
+#pragma once
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+extern char** environ;
+#endif
+#include "engine_plugin.h"
+#include "engine_reactor.hpp"
+#include "engine_scheduling.hpp"
+#include "search_limits.hpp"
+#include "uci_line_queue.hpp"
+#include "uci_parser.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+// Searching without UCI text, for an engine in this process: position, go,
+// stop and ponderhit become these calls, and each search's bestmove is
+// handed back as it is instead of as a line to parse.
+class DirectEngine {
+public:
+    virtual ~DirectEngine() {}
+
+    // fen is empty for the start position; moves are space-separated UCI.
+    virtual void setPosition(const std::string& fen, const std::string& moves) = 0;
+    virtual void search(const SearchLimits& limits, bool ponder) = 0;
+    virtual void stop() = 0;
+    virtual void ponderhit() = 0;
+    // The oldest bestmove not taken yet; searches end in the order started.
+    virtual bool takeBestMove(UciBestMove& best) = 0;
+};
+
+// How ChessEngine reaches an engine. The handshake and options are UCI text
+// through write(); whatever the engine answers arrives in the line queue
+// passed to start(), which the backend closes once the engine is gone.
+// Searches go through direct() when it is not null, as text otherwise.
+class EngineBackend {
+public:
+    virtual ~EngineBackend() {}
+
+    virtual bool start(const std::wstring& path, UciLineQueue& lines) = 0;
+    virtual void write(const char* data, size_t size) = 0;
+    // Asks the engine to quit and forces it after graceMs.
+    virtual void shutdown(int graceMs) = 0;
+
+    virtual DirectEngine* direct() {
+        return nullptr;
+    }
+};
+
+#ifndef _WIN32
+inline bool nativePath(const std::wstring& wide, std::string& path) {
+    path.assign(wide.size() * 4 + 1, '\0');
+    size_t len = std::wcstombs(&path[0], wide.c_str(), path.size());
+    if (len == static_cast<size_t>(-1)) return false;
+    path.resize(len);
+    return true;
+}
+#endif
+
+// A separate engine process talking over its stdin/stdout pipes.
+class PipeBackend : public EngineBackend {
+private:
+#ifdef _WIN32
+    HANDLE hChildStd_IN_Rd = NULL;
+    HANDLE hChildStd_IN_Wr = NULL;
+    HANDLE hChildStd_OUT_Rd = NULL;
+    HANDLE hChildStd_OUT_Wr = NULL;
+    PROCESS_INFORMATION piProcInfo = {};
+#else
+    int childStdInWr = -1;
+    int childStdOutRd = -1;
+    pid_t childPid = -1;
+#endif
+    UciLineQueue* lines = nullptr;
+    std::thread readerThread;
+    bool shareReader;        // read through EngineReactor instead of readerThread
+    uint64_t reactorId = 0;
+
+#ifdef _WIN32
+    bool spawnProcess(const std::wstring& enginePath) {
+        SECURITY_ATTRIBUTES saAttr = { sizeof(SECURITY_ATTRIBUTES) };
+        saAttr.bInheritHandle = TRUE;
+        saAttr.lpSecurityDescriptor = NULL;
+
+        if (!CreatePipe(&hChildStd_OUT_Rd, &hChildStd_OUT_Wr, &saAttr, 0) ||
+            !CreatePipe(&hChildStd_IN_Rd, &hChildStd_IN_Wr, &saAttr, 0)) {
+            std::cerr << "CreatePipe failed: " << GetLastError() << std::endl;
+            return false;
+        }
+
+        STARTUPINFOW siStartInfo = { sizeof(STARTUPINFOW) };
+        siStartInfo.hStdError = hChildStd_OUT_Wr;
+        siStartInfo.hStdOutput = hChildStd_OUT_Wr;
+        siStartInfo.hStdInput = hChildStd_IN_Rd;
+        siStartInfo.dwFlags |= STARTF_USESTDHANDLES;
+
+        std::wstring cmdLine = L"\"" + enginePath + L"\"";
+        if (!CreateProcessW(
+            NULL,
+            &cmdLine[0],
+            NULL,
+            NULL,
+            TRUE,
+            CREATE_NO_WINDOW,
+            NULL,
+            NULL,
+            &siStartInfo,
+            &piProcInfo)) {
+            std::cerr << "CreateProcess failed: " << GetLastError() << std::endl;
+            return false;
+        }
+
+        CloseHandle(hChildStd_OUT_Wr);
+        CloseHandle(hChildStd_IN_Rd);
+        hChildStd_OUT_Wr = NULL;
+        hChildStd_IN_Rd = NULL;
+        return true;
+    }
+
+    // Anonymous pipes have no overlapped I/O, so we peek and sleep on the
+    // process handle instead: an exiting engine wakes us up immediately.
+    int readSome(char* buf, int size, int timeoutMs) {
+        DWORD dwRead = 0;
+        if (timeoutMs < 0) {
+            if (!ReadFile(hChildStd_OUT_Rd, buf, size, &dwRead, NULL)) return -1;
+            return static_cast<int>(dwRead);
+        }
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        DWORD available = 0;
+        while (true) {
+            if (!PeekNamedPipe(hChildStd_OUT_Rd, NULL, 0, NULL, &available, NULL)) return -1;
+            if (available > 0) break;
+
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+            if (remaining <= 0) return 0;
+            WaitForSingleObject(piProcInfo.hProcess, static_cast<DWORD>(remaining < 10 ? remaining : 10));
+        }
+
+        DWORD toRead = available < static_cast<DWORD>(size) ? available : static_cast<DWORD>(size);
+        if (!ReadFile(hChildStd_OUT_Rd, buf, toRead, &dwRead, NULL)) return -1;
+        return static_cast<int>(dwRead);
+    }
+
+    void writeAll(const char* data, size_t size) {
+        DWORD dwWritten;
+        WriteFile(hChildStd_IN_Wr, data, static_cast<DWORD>(size), &dwWritten, NULL);
+    }
+
+    void terminateProcess(int graceMs) {
+        if (hChildStd_IN_Wr) {
+            writeAll("quit\n", 5);
+            CloseHandle(hChildStd_IN_Wr);
+            hChildStd_IN_Wr = NULL;
+        }
+
+        if (piProcInfo.hProcess) {
+            if (WaitForSingleObject(piProcInfo.hProcess, graceMs) == WAIT_TIMEOUT) {
+                TerminateProcess(piProcInfo.hProcess, 1);
+            }
+            CloseHandle(piProcInfo.hProcess);
+            CloseHandle(piProcInfo.hThread);
+            piProcInfo.hProcess = NULL;
+            piProcInfo.hThread = NULL;
+        }
+
+        // The reader sees a broken pipe once the child is gone.
+        if (readerThread.joinable()) readerThread.join();
+
+        if (hChildStd_OUT_Rd) {
+            CloseHandle(hChildStd_OUT_Rd);
+            hChildStd_OUT_Rd = NULL;
+        }
+    }
+#else
+    static bool openPipe(int fds[2]) {
+#ifdef __linux__
+        return pipe2(fds, O_CLOEXEC) == 0;
+#else
+        if (pipe(fds) != 0) return false;
+        fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+        fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+        return true;
+#endif
+    }
+
+    bool spawnProcess(const std::wstring& enginePath) {
+        // A dead engine must surface as a failed write, not kill the game.
+        static const bool sigpipeIgnored = (signal(SIGPIPE, SIG_IGN), true);
+        (void)sigpipeIgnored;
+
+        std::string path;
+        if (!nativePath(enginePath, path)) {
+            std::cerr << "Invalid engine path" << std::endl;
+            return false;
+        }
+
+        // Match CreateProcess, which looks in the working directory before PATH.
+        if (path.find('/') == std::string::npos && access(path.c_str(), X_OK) == 0) {
+            path = "./" + path;
+        }
+
+        int inPipe[2], outPipe[2];
+        if (!openPipe(inPipe)) {
+            std::cerr << "pipe failed: " << strerror(errno) << std::endl;
+            return false;
+        }
+        if (!openPipe(outPipe)) {
+            std::cerr << "pipe failed: " << strerror(errno) << std::endl;
+            close(inPipe[0]);
+            close(inPipe[1]);
+            return false;
+        }
+
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_adddup2(&actions, inPipe[0], STDIN_FILENO);
+        posix_spawn_file_actions_adddup2(&actions, outPipe[1], STDOUT_FILENO);
+        posix_spawn_file_actions_adddup2(&actions, outPipe[1], STDERR_FILENO);
+
+        char* argv[] = { &path[0], nullptr };
+        int err = 0;
+        auto spawn = [&] { err = posix_spawnp(&childPid, path.c_str(), &actions, nullptr, argv, environ); };
+        const EngineSchedulingPolicy& policy = engineSchedulingPolicy();
+        if (policy.enabled) {
+            // The child inherits this thread's cores and nice value; a
+            // throwaway thread keeps them off the caller.
+            std::thread([&] {
+                applyEngineScheduling(policy);
+                spawn();
+            }).join();
+        }
+        else {
+            spawn();
+        }
+        posix_spawn_file_actions_destroy(&actions);
+
+        close(inPipe[0]);
+        close(outPipe[1]);
+
+        if (err != 0) {
+            std::cerr << "posix_spawn failed: " << strerror(err) << std::endl;
+            close(inPipe[1]);
+            close(outPipe[0]);
+            childPid = -1;
+            return false;
+        }
+
+        fcntl(outPipe[0], F_SETFL, fcntl(outPipe[0], F_GETFL) | O_NONBLOCK);
+        childStdInWr = inPipe[1];
+        childStdOutRd = outPipe[0];
+        return true;
+    }
+
+    // Sleeps in poll() until output arrives or the deadline passes (forever for a
+    // negative timeout), so an idle engine costs no CPU while we wait for it.
+    int readSome(char* buf, int size, int timeoutMs) {
+        pollfd pfd = { childStdOutRd, POLLIN, 0 };
+        int ready = poll(&pfd, 1, timeoutMs);
+        if (ready < 0) return errno == EINTR ? 0 : -1;
+        if (ready == 0) return 0;
+
+        ssize_t n = ::read(childStdOutRd, buf, size);
+        if (n > 0) return static_cast<int>(n);
+        if (n < 0 && (errno == EAGAIN || errno == EINTR)) return 0;
+        return -1;
+    }
+
+    void writeAll(const char* data, size_t size) {
+        while (size > 0) {
+            ssize_t n = ::write(childStdInWr, data, size);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return;
+            }
+            data += n;
+            size -= static_cast<size_t>(n);
+        }
+    }
+
+    void terminateProcess(int graceMs) {
+        if (childStdInWr >= 0) {
+            writeAll("quit\n", 5);
+            close(childStdInWr);
+            childStdInWr = -1;
+        }
+
+        if (childPid > 0) {
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(graceMs);
+            while (waitpid(childPid, nullptr, WNOHANG) == 0) {
+                if (std::chrono::steady_clock::now() >= deadline) {
+                    kill(childPid, SIGKILL);
+                    waitpid(childPid, nullptr, 0);
+                    break;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+            childPid = -1;
+        }
+
+        // The reader sees EOF once the child is gone.
+        if (readerThread.joinable()) readerThread.join();
+#ifdef ENGINE_REACTOR_AVAILABLE
+        if (reactorId) {
+            EngineReactor::instance().remove(reactorId);
+            reactorId = 0;
+        }
+#endif
+
+        if (childStdOutRd >= 0) {
+            close(childStdOutRd);
+            childStdOutRd = -1;
+        }
+    }
+#endif
+
+    // Splits engine stdout into lines on a dedicated thread so nobody has to
+    // re-scan a growing buffer.
+    void readerLoop() {
+        const int BUFSIZE = 4096;
+        char chBuf[BUFSIZE];
+        int n;
+        while ((n = readSome(chBuf, BUFSIZE, -1)) >= 0) {
+            ++threadWakeups();
+            if (n > 0) lines->feed(chBuf, n);
+        }
+        lines->close();
+    }
+
+public:
+    // With shareReader every engine's output is read by the one
+    // EngineReactor thread where the platform has one (Linux/epoll);
+    // otherwise each backend runs its own reader thread.
+    explicit PipeBackend(bool shareReader = true) : shareReader(shareReader) {}
+    PipeBackend(const PipeBackend&) = delete;
+    PipeBackend& operator=(const PipeBackend&) = delete;
+
+    ~PipeBackend() {
+        shutdown(1000);
+    }
+
+    bool start(const std::wstring& path, UciLineQueue& output) override {
+        if (!spawnProcess(path)) return false;
+        lines = &output;
+#ifdef ENGINE_REACTOR_AVAILABLE
+        if (shareReader) {
+            reactorId = EngineReactor::instance().add(childStdOutRd, output);
+            if (reactorId) return true;
+        }
+#endif
+        readerThread = std::thread(&PipeBackend::readerLoop, this);
+        return true;
+    }
+
+    // Returns from the per-engine reader threads' waits, for the benchmark.
+    static std::atomic<uint64_t>& threadWakeups() {
+        static std::atomic<uint64_t> count{ 0 };
+        return count;
+    }
+
+    void write(const char* data, size_t size) override {
+        writeAll(data, size);
+    }
+
+    void shutdown(int graceMs) override {
+        terminateProcess(graceMs);
+    }
+};
+
+// An engine library loaded into this process through the engine_plugin.h
+// C ABI. There is no child process and no pipe: searches are direct calls
+// and bestmoves come back as they are. Only the handshake, options and info
+// lines are still text, formatted straight into the line queue.
+class PluginBackend : public EngineBackend, public DirectEngine {
+private:
+#ifdef _WIN32
+    typedef HMODULE LibraryHandle;
+#else
+    typedef void* LibraryHandle;
+#endif
+    static const size_t REPLY_RESERVE = 64; // slots info lines leave free for replies
+
+    // Where the plugin's callbacks land. Shared with the thread running
+    // destroy(), which outlives the backend if the plugin overruns its
+    // shutdown deadline.
+    struct Sink {
+        std::mutex mutex;              // the plugin's search thread and our replies both produce
+        std::condition_variable destroyedCv;
+        UciLineQueue* lines = nullptr; // null once nothing may be pushed any more
+        std::deque<UciBestMove> bestMoves;
+        bool destroyed = false;
+        bool abandoned = false;        // shutdown stopped waiting for destroy()
+    };
+
+    LibraryHandle library = LibraryHandle();
+    const VcEngineApi* api = nullptr;
+    void* engine = nullptr;
+    UciLineQueue* lines = nullptr;
+    std::shared_ptr<Sink> sink;
+    std::string pending; // partial command from write()
+
+    // Never waits, whichever thread calls: the caller may be the queue's
+    // only consumer, or a search thread that stop() is joining. An info
+    // line that finds the queue nearly full is dropped; its reader has
+    // fallen behind and only the bestmove matters.
+    static void emit(Sink& to, std::string_view text, size_t reserve) {
+        std::lock_guard<std::mutex> lock(to.mutex);
+        if (!to.lines) return;
+        while (!text.empty()) {
+            size_t end = text.find('\n');
+            std::string_view line = text.substr(0, end);
+            if (!line.empty()) to.lines->tryPushLine(line.data(), line.size(), reserve);
+            text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+        }
+    }
+
+    void reply(std::string_view text) {
+        emit(*sink, text, 0);
+    }
+
+    static void onInfo(void* user, const VcEngineInfo* info) {
+        char buf[512];
+        int n = snprintf(buf, sizeof(buf), "info depth %d seldepth %d multipv %d", info->depth, info->seldepth,
+            info->multipv > 0 ? info->multipv : 1);
+        if (info->score_kind != VC_SCORE_NONE && n < static_cast<int>(sizeof(buf))) {
+            n += snprintf(buf + n, sizeof(buf) - n, " score %s %d",
+                info->score_kind == VC_SCORE_MATE ? "mate" : "cp", info->score);
+        }
+        if (n < static_cast<int>(sizeof(buf))) {
+            n += snprintf(buf + n, sizeof(buf) - n, " nodes %llu nps %llu time %lld",
+                static_cast<unsigned long long>(info->nodes), static_cast<unsigned long long>(info->nps),
+                static_cast<long long>(info->time_ms));
+        }
+        std::string line(buf, n < static_cast<int>(sizeof(buf)) ? n : sizeof(buf) - 1);
+        if (info->pv && *info->pv) line.append(" pv ").append(info->pv);
+        emit(*static_cast<Sink*>(user), line, REPLY_RESERVE);
+    }
+
+    static void onBestMove(void* user, const char* best, const char* ponder) {
+        Sink& to = *static_cast<Sink*>(user);
+        UciBestMove result;
+        if (best) result.move = parseUciMove(best);
+        if (ponder) result.ponder = parseUciMove(ponder);
+        std::lock_guard<std::mutex> lock(to.mutex);
+        if (to.lines) to.bestMoves.push_back(result);
+    }
+
+    void handleCommand(std::string_view command) {
+        UciTokenizer tokens(command);
+        std::string_view verb;
+        if (!tokens.next(verb)) return;
+
+        if (verb == "uci") {
+            reply(std::string("id name ") + (api->name ? api->name : "plugin"));
+            if (api->options) reply(api->options);
+            reply("uciok");
+        }
+        else if (verb == "isready") {
+            reply("readyok");
+        }
+        else if (verb == "setoption") {
+            // setoption name <name...> value <value...>
+            std::string_view rest = tokens.rest();
+            if (rest.compare(0, 5, "name ") != 0) return;
+            rest.remove_prefix(5);
+            size_t valueAt = rest.find(" value ");
+            std::string name(rest.substr(0, valueAt));
+            std::string value(valueAt == std::string_view::npos ? std::string_view() : rest.substr(valueAt + 7));
+            api->set_option(engine, name.c_str(), value.c_str());
+        }
+        else if (verb == "ucinewgame") {
+            api->new_game(engine);
+        }
+    }
+
+    static void unloadLibrary(LibraryHandle handle) {
+        if (!handle) return;
+#ifdef _WIN32
+        FreeLibrary(handle);
+#else
+        dlclose(handle);
+#endif
+    }
+
+    void unload() {
+        unloadLibrary(library);
+        library = LibraryHandle();
+        api = nullptr;
+    }
+
+public:
+    PluginBackend() = default;
+    PluginBackend(const PluginBackend&) = delete;
+    PluginBackend& operator=(const PluginBackend&) = delete;
+
+    ~PluginBackend() {
+        shutdown(1000);
+    }
+
+    bool start(const std::wstring& path, UciLineQueue& output) override {
+        VcEngineApiFunc entry = nullptr;
+#ifdef _WIN32
+        library = LoadLibraryW(path.c_str());
+        if (!library) {
+            std::cerr << "LoadLibrary failed: " << GetLastError() << std::endl;
+            return false;
+        }
+        entry = reinterpret_cast<VcEngineApiFunc>(GetProcAddress(library, "vc_engine_api"));
+#else
+        std::string file;
+        if (!nativePath(path, file)) return false;
+        if (file.find('/') == std::string::npos) file = "./" + file;
+        library = dlopen(file.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (!library) {
+            std::cerr << "dlopen failed: " << dlerror() << std::endl;
+            return false;
+        }
+        entry = reinterpret_cast<VcEngineApiFunc>(dlsym(library, "vc_engine_api"));
+#endif
+        api = entry ? entry() : nullptr;
+        if (!api || api->abi_version != VC_ENGINE_ABI_VERSION) {
+            std::cerr << "Not a compatible engine plugin" << std::endl;
+            unload();
+            return false;
+        }
+
+        lines = &output;
+        sink = std::make_shared<Sink>();
+        sink->lines = &output;
+        engine = api->create(&PluginBackend::onInfo, &PluginBackend::onBestMove, sink.get());
+        if (!engine) {
+            unload();
+            return false;
+        }
+        return true;
+    }
+
+    void write(const char* data, size_t size) override {
+        if (!engine) return;
+        pending.append(data, size);
+        size_t start = 0, end;
+        while ((end = pending.find('\n', start)) != std::string::npos) {
+            handleCommand(std::string_view(pending).substr(start, end - start));
+            start = end + 1;
+        }
+        pending.erase(0, start);
+    }
+
+    // A thread cannot be killed, so destroy() runs on one of its own that
+    // we stop waiting for after graceMs. A plugin that overruns is cut off
+    // from the line queue and left to finish; its library is unloaded when
+    // it does, and never if it hangs for good.
+    void shutdown(int graceMs) override {
+        if (engine) {
+            std::shared_ptr<Sink> state = sink;
+            const VcEngineApi* plugin = api;
+            void* handle = engine;
+            LibraryHandle module = library;
+            std::thread destroyer([state, plugin, handle, module] {
+                plugin->destroy(handle); // stops any search; no callbacks after this
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->destroyed = true;
+                if (state->abandoned) unloadLibrary(module);
+                state->destroyedCv.notify_all();
+            });
+
+            bool destroyed;
+            {
+                std::unique_lock<std::mutex> lock(sink->mutex);
+                destroyed = sink->destroyedCv.wait_for(lock, std::chrono::milliseconds(graceMs > 0 ? graceMs : 0),
+                    [&] { return sink->destroyed; });
+                if (!destroyed) {
+                    sink->abandoned = true;
+                    sink->lines = nullptr;
+                }
+            }
+            if (destroyed) {
+                destroyer.join();
+            }
+            else {
+                std::cerr << "Engine plugin still running after " << graceMs << " ms, left behind" << std::endl;
+                destroyer.detach();
+                library = LibraryHandle(); // the destroyer's to unload now
+            }
+            engine = nullptr;
+            lines->close();
+        }
+        unload();
+    }
+
+    DirectEngine* direct() override {
+        return this;
+    }
+
+    void setPosition(const std::string& fen, const std::string& moves) override {
+        if (engine) api->set_position(engine, fen.empty() ? nullptr : fen.c_str(), moves.c_str());
+    }
+
+    void search(const SearchLimits& limits, bool ponder) override {
+        if (!engine) return;
+        VcSearchLimits plugin = {};
+        switch (limits.mode) {
+        case SearchLimits::MoveTime:
+            plugin.movetime_ms = limits.moveTimeMs;
+            break;
+        case SearchLimits::Nodes:
+            plugin.nodes = limits.nodes;
+            break;
+        case SearchLimits::Clock:
+            plugin.wtime_ms = limits.whiteTimeMs;
+            plugin.btime_ms = limits.blackTimeMs;
+            plugin.winc_ms = limits.whiteIncrementMs;
+            plugin.binc_ms = limits.blackIncrementMs;
+            plugin.nodes = limits.nodes;
+            break;
+        case SearchLimits::Infinite:
+            plugin.infinite = 1;
+            break;
+        default:
+            plugin.depth = limits.depth;
+            break;
+        }
+        plugin.ponder = ponder ? 1 : 0;
+        api->search(engine, &plugin);
+    }
+
+    void stop() override {
+        if (engine) api->stop(engine);
+    }
+
+    void ponderhit() override {
+        if (engine) api->ponderhit(engine);
+    }
+
+    bool takeBestMove(UciBestMove& best) override {
+        if (!sink) return false;
+        std::lock_guard<std::mutex> lock(sink->mutex);
+        if (sink->bestMoves.empty()) return false;
+        best = sink->bestMoves.front();
+        sink->bestMoves.pop_front();
+        return true;
+    }
+};
+
+// Engine libraries (.dll/.so/.dylib) run in-process, anything else is spawned.
+inline bool isEnginePlugin(const std::wstring& path) {
+    const wchar_t* const SUFFIXES[] = { L".dll", L".so", L".dylib" };
+    for (const wchar_t* suffix : SUFFIXES) {
+        std::wstring ending(suffix);
+        if (path.size() > ending.size() && path.compare(path.size() - ending.size(), ending.size(), ending) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline std::unique_ptr<EngineBackend> makeEngineBackend(const std::wstring& path) {
+    if (isEnginePlugin(path)) return std::unique_ptr<EngineBackend>(new PluginBackend());
+    return std::unique_ptr<EngineBackend>(new PipeBackend());
+}
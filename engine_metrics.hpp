@@ -0,0 +1,89 @@
+// engine_metrics.hpp
+#pragma once
+#include "histogram.hpp"
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Latencies are in microseconds, sizes in bytes.
+enum EngineMetric {
+    METRIC_HANDSHAKE_US,  // spawn to the first readyok
+    METRIC_ISREADY_US,    // isready to readyok
+    METRIC_SEARCH_US,     // go (or ponderhit) to bestmove
+    METRIC_SEARCH_NODES,  // nodes of the last info line before bestmove
+    METRIC_SEARCH_NPS,
+    METRIC_BYTES_OUT,     // per command written
+    METRIC_BYTES_IN,      // engine output read during one search
+    METRIC_APPLY_US,      // makeBotMove: playing the reply, mate check included
+    METRIC_WRITES,        // backend writes (syscalls) from one bestmove to the next
+    METRIC_COUNT
+};
+
+// Process-wide round-trip and throughput statistics for every engine,
+// grouped by the difficulty level the engine was set to (-1 before
+// setDifficulty, e.g. while the pool warms engines up). Engines record from
+// the UI thread and the pool's worker, so every access takes the lock.
+class EngineMetrics {
+private:
+    mutable std::mutex mutex;
+    std::map<int, std::vector<Histogram>> levels; // METRIC_COUNT histograms per level
+
+    EngineMetrics() = default;
+
+public:
+    static EngineMetrics& instance() {
+        static EngineMetrics metrics;
+        return metrics;
+    }
+
+    static const char* metricName(EngineMetric metric) {
+        static const char* const NAMES[METRIC_COUNT] = {
+            "handshake_us", "isready_us", "search_us", "search_nodes", "search_nps", "bytes_out", "bytes_in",
+            "apply_us", "writes"
+        };
+        return NAMES[metric];
+    }
+
+    void record(int level, EngineMetric metric, uint64_t value) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<Histogram>& histograms = levels[level];
+        if (histograms.empty()) histograms.resize(METRIC_COUNT);
+        histograms[metric].record(value);
+    }
+
+    // p50/p99 of one metric, false if nothing was recorded for it.
+    bool summary(int level, EngineMetric metric, uint64_t& p50, uint64_t& p99, uint64_t& count) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = levels.find(level);
+        if (it == levels.end()) return false;
+        const Histogram& h = it->second[metric];
+        if (h.count() == 0) return false;
+        p50 = h.percentile(50);
+        p99 = h.percentile(99);
+        count = h.count();
+        return true;
+    }
+
+    // One row per (level, metric) that has samples.
+    bool writeCsv(const std::string& path) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (levels.empty()) return true;
+
+        std::ofstream file(path);
+        if (!file) return false;
+        file << "level,metric,count,min,p50,p90,p99,max,mean\n";
+        for (const auto& entry : levels) {
+            for (int m = 0; m < METRIC_COUNT; ++m) {
+                const Histogram& h = entry.second[m];
+                if (h.count() == 0) continue;
+                file << entry.first << ',' << metricName(static_cast<EngineMetric>(m)) << ','
+                    << h.count() << ',' << h.minimum() << ',' << h.percentile(50) << ','
+                    << h.percentile(90) << ',' << h.percentile(99) << ',' << h.maximum() << ','
+                    << static_cast<uint64_t>(h.mean() + 0.5) << '\n';
+            }
+        }
+        return static_cast<bool>(file);
+    }
+};
@@ -0,0 +1,76 @@
+/* engine_plugin.h */
+#pragma once
+#include <stdint.h>
+
+/* C ABI for engines loaded into the game's process instead of spawned.
+ * A plugin is a shared library exporting vc_engine_api(). The game calls
+ * into it from one thread at a time; the plugin may call back from any
+ * thread, but never after destroy() has returned. */
+
+#ifdef _WIN32
+#define VC_ENGINE_EXPORT __declspec(dllexport)
+#else
+#define VC_ENGINE_EXPORT __attribute__((visibility("default")))
+#endif
+
+#define VC_ENGINE_ABI_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum VcScoreKind { VC_SCORE_NONE = 0, VC_SCORE_CP = 1, VC_SCORE_MATE = 2 };
+
+typedef struct VcEngineInfo {
+    int depth;
+    int seldepth;
+    int multipv;
+    int score_kind;         /* VcScoreKind */
+    int score;
+    uint64_t nodes;
+    uint64_t nps;
+    int64_t time_ms;
+    const char* pv;         /* space-separated UCI moves, may be empty */
+} VcEngineInfo;
+
+/* Zero fields are unset; with none set the search runs until stop(). */
+typedef struct VcSearchLimits {
+    int depth;
+    int movetime_ms;
+    uint64_t nodes;
+    int wtime_ms;
+    int btime_ms;
+    int winc_ms;
+    int binc_ms;
+    int infinite;
+    int ponder;             /* think until ponderhit(), then search normally */
+} VcSearchLimits;
+
+typedef void (*VcInfoCallback)(void* user, const VcEngineInfo* info);
+/* best is "" when the side to move has no legal move; ponder may be "". */
+typedef void (*VcBestMoveCallback)(void* user, const char* best, const char* ponder);
+
+typedef struct VcEngineApi {
+    int abi_version;        /* VC_ENGINE_ABI_VERSION */
+    const char* name;
+    const char* options;    /* UCI "option name ..." lines, '\n'-separated */
+
+    void* (*create)(VcInfoCallback on_info, VcBestMoveCallback on_bestmove, void* user);
+    void (*destroy)(void* engine);  /* stops any search first */
+    void (*set_option)(void* engine, const char* name, const char* value);
+    void (*new_game)(void* engine);
+    /* fen is NULL for the start position; moves is space-separated UCI. */
+    void (*set_position)(void* engine, const char* fen, const char* moves);
+    /* Returns at once; exactly one bestmove callback follows. */
+    void (*search)(void* engine, const VcSearchLimits* limits);
+    void (*stop)(void* engine);
+    void (*ponderhit)(void* engine);
+} VcEngineApi;
+
+typedef const VcEngineApi* (*VcEngineApiFunc)(void);
+
+VC_ENGINE_EXPORT const VcEngineApi* vc_engine_api(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,293 @@
+// engine_pool.hpp
+#pragma once
+#include "engine.hpp"
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Process-wide set of engines that have already finished the uci/isready
+// handshake. Games lease one and hand it back when they end; a background
+// thread resets returned engines with ucinewgame and tops the pool up, so
+// starting a game never waits for a process to spawn. Threads and Hash are
+// split across the engines that can search at once, the game's and one per
+// idle slot (speculation leases at most that many); when warmUp changes the
+// count, idle and returned engines are resized before they are leased again.
+// The game's engine gets the larger Hash: while no game is running one idle
+// engine is kept sized for it, and the rest are sized as spares.
+class EnginePool {
+private:
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<std::unique_ptr<ChessEngine>> idle;     // handshaken, ready to lease
+    std::vector<std::unique_ptr<ChessEngine>> returned; // waiting for ucinewgame/readyok
+    std::wstring enginePath = defaultEnginePath();
+    size_t targetIdle = 1;
+    bool spawning = false;
+    bool spawnFailed = false; // stop retrying a missing engine until someone asks again
+    bool stopping = false;
+    const ChessEngine* gameEngine = nullptr; // leased to the running game
+    std::thread worker;
+
+    // Engines record metrics until they close, so the metrics must outlive
+    // the pool: statics are destroyed in reverse order of construction.
+    EnginePool() {
+        EngineMetrics::instance();
+    }
+
+    int plannedEngines() const {
+        return static_cast<int>(targetIdle) + 1; // the idle ones plus the game's
+    }
+
+    bool sizedForPlan(const ChessEngine& engine, bool game) const {
+        const EngineResources& applied = engine.appliedResources();
+        return applied.engines == plannedEngines() && applied.game == game;
+    }
+
+    std::vector<std::unique_ptr<ChessEngine>>::iterator findIdle(bool game) {
+        for (auto it = idle.begin(); it != idle.end(); ++it) {
+            if (sizedForPlan(**it, game)) return it;
+        }
+        return idle.end();
+    }
+
+    // No game is running and no idle engine is sized for the next one.
+    bool wantsGameEngine() {
+        return !gameEngine && findIdle(true) == idle.end();
+    }
+
+    // An idle engine sized for an older plan, or for the game while one is
+    // running or another idle engine is already kept for it.
+    std::vector<std::unique_ptr<ChessEngine>>::iterator findMisfit() {
+        bool kept = false;
+        for (auto it = idle.begin(); it != idle.end(); ++it) {
+            if (sizedForPlan(**it, false)) continue;
+            if (sizedForPlan(**it, true) && !gameEngine && !kept) {
+                kept = true;
+                continue;
+            }
+            return it;
+        }
+        return idle.end();
+    }
+
+    bool hasWork() {
+        return stopping || !returned.empty() || findMisfit() != idle.end() ||
+            (wantsGameEngine() && !idle.empty()) || (idle.size() < targetIdle && !spawnFailed);
+    }
+
+    void workerLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            cv.wait(lock, [&] { return hasWork(); });
+            if (stopping) return;
+
+            std::unique_ptr<ChessEngine> engine;
+            bool ok;
+            int engines = plannedEngines();
+            bool game = wantsGameEngine();
+            auto resize = findMisfit();
+            if (resize == idle.end() && game && !idle.empty()) resize = idle.begin(); // a spare becomes the game's
+            if (!returned.empty()) {
+                engine = std::move(returned.back());
+                returned.pop_back();
+                bool sized = sizedForPlan(*engine, game);
+                lock.unlock();
+                ok = engine->resetForNewGame() && (sized || engine->applyResources(planEngineResources(engines, game)));
+            }
+            else if (resize != idle.end()) {
+                engine = std::move(*resize);
+                idle.erase(resize);
+                lock.unlock();
+                ok = engine->applyResources(planEngineResources(engines, game));
+            }
+            else {
+                spawning = true;
+                std::wstring path = enginePath;
+                lock.unlock();
+                engine.reset(new ChessEngine());
+                ok = engine->ConnectToEngine(path) && engine->applyResources(planEngineResources(engines, game));
+            }
+
+            // Closing a broken engine may wait for it, so do it unlocked.
+            if (!ok) engine.reset();
+
+            lock.lock();
+            if (spawning) {
+                spawning = false;
+                if (!engine) spawnFailed = true;
+            }
+            if (engine) idle.push_back(std::move(engine));
+            cv.notify_all();
+        }
+    }
+
+    void startWorker() {
+        if (!worker.joinable()) worker = std::thread(&EnginePool::workerLoop, this);
+    }
+
+    // No engine is coming: the pool is closing, or spawning failed with
+    // nothing left to reset.
+    bool cannotSupply() const {
+        return stopping || (spawnFailed && !spawning && returned.empty());
+    }
+
+    // An idle engine sized for the plan and the role, or with anySizing any
+    // idle one. A spare may take the engine kept for the next game, since
+    // none is kept while a game is running.
+    std::unique_ptr<ChessEngine> takeIdle(bool game, bool anySizing) {
+        auto chosen = findIdle(game);
+        if (chosen == idle.end() && !game) chosen = findIdle(true);
+        if (chosen == idle.end() && anySizing && !idle.empty()) chosen = idle.begin();
+        if (chosen == idle.end()) return nullptr;
+
+        std::unique_ptr<ChessEngine> engine = std::move(*chosen);
+        idle.erase(chosen);
+        if (game) gameEngine = engine.get();
+        cv.notify_all(); // let the worker refill behind us
+        return engine;
+    }
+
+public:
+    static EnginePool& instance() {
+        static EnginePool pool;
+        return pool;
+    }
+
+    EnginePool(const EnginePool&) = delete;
+    EnginePool& operator=(const EnginePool&) = delete;
+
+    ~EnginePool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        cv.notify_all();
+        if (worker.joinable()) worker.join();
+
+        // Closing only hands the engines to the reaper; give it until the
+        // kill deadline so no engine outlives the game.
+        idle.clear();
+        returned.clear();
+        EngineReaper::instance().drain(2000);
+    }
+
+    // Starts spawning in the background so an engine is ready before the
+    // player picks a game. `idleCount` is also how many engines besides the
+    // game's may search at once, which sizes every engine's Threads and Hash.
+    void warmUp(size_t idleCount = 1, const std::wstring& path = defaultEnginePath()) {
+        std::lock_guard<std::mutex> lock(mutex);
+        targetIdle = idleCount;
+        enginePath = path;
+        spawnFailed = false;
+        startWorker();
+        cv.notify_all();
+    }
+
+    // Returns a handshaken engine sized for the game under the current plan,
+    // waiting for one still being spawned or resized. Once the wait is over
+    // an engine with other sizing is better than none. acquire(0) is for
+    // spare work such as analysis and speculation: it never waits and so
+    // takes only a spare that is ready. nullptr if no engine could be started.
+    std::unique_ptr<ChessEngine> acquire(int timeoutMs = 6000) {
+        std::unique_lock<std::mutex> lock(mutex);
+        spawnFailed = false;
+        startWorker();
+        cv.notify_all();
+
+        bool game = timeoutMs > 0;
+        cv.wait_for(lock, std::chrono::milliseconds(timeoutMs), [&] {
+            return findIdle(game) != idle.end() || cannotSupply();
+        });
+        return takeIdle(game, game);
+    }
+
+    // acquire(timeoutMs) for a game that must not wait, such as the UI
+    // thread: kick() once, then tryAcquire every frame. nullptr until an engine is ready;
+    // `failed` is set when none will be.
+    void kick() {
+        std::lock_guard<std::mutex> lock(mutex);
+        spawnFailed = false;
+        startWorker();
+        cv.notify_all();
+    }
+
+    std::unique_ptr<ChessEngine> tryAcquire(bool anySizing, bool& failed) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::unique_ptr<ChessEngine> engine = takeIdle(true, anySizing);
+        failed = !engine && idle.empty() && cannotSupply();
+        return engine;
+    }
+
+    void release(std::unique_ptr<ChessEngine> engine) {
+        if (!engine) return;
+        std::lock_guard<std::mutex> lock(mutex);
+        if (engine.get() == gameEngine) gameEngine = nullptr;
+        returned.push_back(std::move(engine));
+        cv.notify_all();
+    }
+};
+
+// Engine borrowed from EnginePool for the lifetime of one game session.
+class EngineLease {
+private:
+    std::unique_ptr<ChessEngine> engine;
+
+public:
+    explicit EngineLease(std::unique_ptr<ChessEngine> engine) : engine(std::move(engine)) {}
+    EngineLease(EngineLease&&) = default;
+
+    ~EngineLease() {
+        EnginePool::instance().release(std::move(engine));
+    }
+
+    explicit operator bool() const {
+        return engine != nullptr;
+    }
+
+    ChessEngine& operator*() const {
+        return *engine;
+    }
+
+    ChessEngine* operator->() const {
+        return engine.get();
+    }
+};
+
+// An engine asked for without blocking: poll() once per frame until it
+// returns true, then take() it (nullptr if none could be started). Past
+// patienceMs an engine still sized for an older plan is taken rather than
+// waited on, as acquire does. One taken and never claimed goes back.
+class EngineRequest {
+private:
+    std::chrono::steady_clock::time_point startedAt = std::chrono::steady_clock::now();
+    int patienceMs;
+    bool done = false;
+    std::unique_ptr<ChessEngine> engine;
+
+public:
+    explicit EngineRequest(int patienceMs = 6000) : patienceMs(patienceMs) {
+        EnginePool::instance().kick();
+    }
+    EngineRequest(const EngineRequest&) = delete;
+    EngineRequest& operator=(const EngineRequest&) = delete;
+
+    ~EngineRequest() {
+        EnginePool::instance().release(std::move(engine));
+    }
+
+    bool poll() {
+        if (done) return true;
+        bool patient = std::chrono::steady_clock::now() - startedAt < std::chrono::milliseconds(patienceMs);
+        bool failed = false;
+        engine = EnginePool::instance().tryAcquire(!patient, failed);
+        done = engine || failed;
+        return done;
+    }
+
+    std::unique_ptr<ChessEngine> take() {
+        return std::move(engine);
+    }
+};
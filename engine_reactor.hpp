@@ -0,0 +1,158 @@
+// engine_reactor.hpp
+#pragma once
+#ifdef __linux__
+#include "uci_line_queue.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <sys/epoll.h>
+#include <thread>
+#include <unistd.h>
+
+#define ENGINE_REACTOR_AVAILABLE 1
+
+// One thread that reads the stdout pipes of every engine through epoll and
+// feeds each one's line queue, instead of a blocked reader thread per
+// engine. A queue its consumer is not draining is paused rather than
+// allowed to block the thread, so one slow game never stalls the others:
+// no read is ever larger than the queue has room for, whatever the lines.
+class EngineReactor {
+private:
+    static const int MAX_EVENTS = 64;
+    static const size_t MIN_FREE_SLOTS = 256; // below this, reads get too small to be worth it
+
+    struct Registration {
+        int fd;
+        UciLineQueue* lines;
+        bool paused;
+    };
+
+    int epollFd = -1;
+    std::thread thread;
+    std::mutex mutex; // held while dispatching, so remove() never races a read
+    std::map<uint64_t, Registration> registrations;
+    uint64_t nextId = 1;
+    size_t pausedCount = 0;
+    std::atomic<uint64_t> wakeupCount{ 0 };
+    std::atomic<uint64_t> readCount{ 0 };
+
+    EngineReactor() {
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        thread = std::thread(&EngineReactor::loop, this);
+    }
+
+    bool watch(uint64_t id, int fd) {
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.u64 = id;
+        return epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) == 0;
+    }
+
+    void unregister(std::map<uint64_t, Registration>::iterator it) {
+        if (!it->second.paused) epoll_ctl(epollFd, EPOLL_CTL_DEL, it->second.fd, nullptr);
+        if (it->second.paused) --pausedCount;
+        it->second.lines->close();
+        registrations.erase(it);
+    }
+
+    // Reads until the pipe is empty or the queue needs draining first. A read
+    // of n bytes completes at most (n + 1) / 2 lines: the first may only be
+    // the '\n' ending a partial one, every other needs a character and a
+    // '\n', and empty lines are not queued. Capping reads by that keeps
+    // feed() from ever waiting for the consumer while the lock is held.
+    void drain(std::map<uint64_t, Registration>::iterator it) {
+        Registration& registration = it->second;
+        char buf[4096];
+        while (true) {
+            size_t freeSlots = registration.lines->freeSlots();
+            if (freeSlots < MIN_FREE_SLOTS) {
+                // Out of the epoll set, or a hung-up pipe would wake us nonstop.
+                if (!registration.paused) {
+                    registration.paused = true;
+                    ++pausedCount;
+                    epoll_ctl(epollFd, EPOLL_CTL_DEL, registration.fd, nullptr);
+                }
+                return;
+            }
+            if (registration.paused) {
+                registration.paused = false;
+                --pausedCount;
+                watch(it->first, registration.fd);
+            }
+
+            size_t limit = std::min(sizeof(buf), 2 * freeSlots - 1);
+            ssize_t n = ::read(registration.fd, buf, limit);
+            if (n > 0) {
+                ++readCount;
+                registration.lines->feed(buf, static_cast<size_t>(n));
+                if (static_cast<size_t>(n) < limit) return;
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && errno == EAGAIN) return;
+            unregister(it); // EOF or a broken pipe: the engine is gone
+            return;
+        }
+    }
+
+    void loop() {
+        epoll_event events[MAX_EVENTS];
+        while (true) {
+            // Paused queues are retried every few ms until their consumer catches up.
+            int timeoutMs = pausedCount > 0 ? 5 : -1;
+            int n = epoll_wait(epollFd, events, MAX_EVENTS, timeoutMs);
+            if (n < 0 && errno != EINTR) return;
+            ++wakeupCount;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            for (int i = 0; i < n; ++i) {
+                auto it = registrations.find(events[i].data.u64);
+                if (it != registrations.end()) drain(it);
+            }
+            if (pausedCount > 0) {
+                for (auto it = registrations.begin(); it != registrations.end();) {
+                    auto next = std::next(it);
+                    if (it->second.paused) drain(it);
+                    it = next;
+                }
+            }
+        }
+    }
+
+public:
+    // Never destroyed: engines owned by other singletons may still
+    // unregister while static objects are torn down.
+    static EngineReactor& instance() {
+        static EngineReactor* reactor = new EngineReactor();
+        return *reactor;
+    }
+
+    EngineReactor(const EngineReactor&) = delete;
+    EngineReactor& operator=(const EngineReactor&) = delete;
+
+    // Starts feeding `lines` from the non-blocking pipe `fd`. The queue is
+    // closed when the engine exits or the registration is removed.
+    uint64_t add(int fd, UciLineQueue& lines) {
+        std::lock_guard<std::mutex> lock(mutex);
+        uint64_t id = nextId++;
+        if (!watch(id, fd)) return 0;
+        registrations[id] = Registration{ fd, &lines, false };
+        return id;
+    }
+
+    // Once this returns the reactor touches neither the pipe nor the queue.
+    void remove(uint64_t id) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = registrations.find(id);
+        if (it != registrations.end()) unregister(it);
+    }
+
+    // Returns from epoll_wait and successful pipe reads, for the benchmark.
+    uint64_t wakeups() const { return wakeupCount.load(); }
+    uint64_t reads() const { return readCount.load(); }
+};
+#endif
@@ -0,0 +1,91 @@
+// engine_reaper.hpp
+#pragma once
+#include "engine_backend.hpp"
+#include "uci_line_queue.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Shuts engines down off the caller's thread. A closed engine is handed
+// over with the line queue its backend still feeds; each one gets until its
+// deadline to quit on its own and is killed after that. Closing an engine
+// therefore never waits on the engine, however busy it is. The queue is
+// abandoned on handover, so a reader stuck on a full queue nobody drains
+// any more cannot keep the shutdown from finishing.
+class EngineReaper {
+private:
+    struct Closing {
+        std::unique_ptr<EngineBackend> backend;
+        std::unique_ptr<UciLineQueue> lines; // outlives the backend feeding it
+        std::chrono::steady_clock::time_point deadline;
+    };
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<Closing> pending;
+    size_t inFlight = 0;
+    bool started = false;
+
+    EngineReaper() = default;
+
+    void loop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            cv.wait(lock, [&] { return !pending.empty(); });
+            Closing closing = std::move(pending.front());
+            pending.pop_front();
+            ++inFlight;
+            lock.unlock();
+
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                closing.deadline - std::chrono::steady_clock::now()).count();
+            closing.backend->shutdown(remaining > 0 ? static_cast<int>(remaining) : 0);
+            closing.backend.reset();
+            closing.lines.reset();
+
+            lock.lock();
+            --inFlight;
+            cv.notify_all();
+        }
+    }
+
+public:
+    // Never destroyed: engines owned by other singletons are still handed
+    // over while static objects are torn down.
+    static EngineReaper& instance() {
+        static EngineReaper* reaper = new EngineReaper();
+        return *reaper;
+    }
+
+    EngineReaper(const EngineReaper&) = delete;
+    EngineReaper& operator=(const EngineReaper&) = delete;
+
+    // Takes the engine over; it is killed if still running after graceMs.
+    void reap(std::unique_ptr<EngineBackend> backend, std::unique_ptr<UciLineQueue> lines, int graceMs) {
+        if (!backend) return;
+        if (lines) lines->abandon();
+        Closing closing;
+        closing.backend = std::move(backend);
+        closing.lines = std::move(lines);
+        closing.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(graceMs);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.push_back(std::move(closing));
+        if (!started) {
+            std::thread(&EngineReaper::loop, this).detach();
+            started = true;
+        }
+        cv.notify_all();
+    }
+
+    // Waits until every engine handed over so far is gone, for process exit.
+    // False if that took longer than timeoutMs.
+    bool drain(int timeoutMs) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return cv.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+            [&] { return pending.empty() && inFlight == 0; });
+    }
+};
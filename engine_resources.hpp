@@ -0,0 +1,77 @@
+// engine_resources.hpp
+#pragma once
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+#include <cstdint>
+#include <string>
+#include <thread>
+
+// Threads and Hash for one engine out of `engines` that may run at once.
+struct EngineResources {
+    int threads = 1;              // <= 0: left at the engine's default
+    int64_t hashMb = 16;
+    bool game = false;            // the game's engine rather than a spare
+    unsigned hardwareThreads = 0; // what the plan was made from, for the log line
+    uint64_t availableMb = 0;
+    int engines = 1;
+
+    std::string describe() const {
+        return "Threads=" + (threads > 0 ? std::to_string(threads) : "default") +
+            " Hash=" + (hashMb > 0 ? std::to_string(hashMb) + " MB" : "default") + " (" +
+            (game ? "game, " : "spare, ") + std::to_string(hardwareThreads) + " hardware threads, " + std::to_string(availableMb) +
+            " MB free, " + std::to_string(engines) + " engine(s))";
+    }
+};
+
+// Physical memory not in use right now, 0 if the platform will not say.
+inline uint64_t availableMemoryMb() {
+#ifdef _WIN32
+    MEMORYSTATUSEX status = { sizeof(MEMORYSTATUSEX) };
+    if (!GlobalMemoryStatusEx(&status)) return 0;
+    return status.ullAvailPhys / (1024 * 1024);
+#else
+    long pages = sysconf(_SC_AVPHYS_PAGES);
+    long pageSize = sysconf(_SC_PAGESIZE);
+    if (pages <= 0 || pageSize <= 0) return 0;
+    return static_cast<uint64_t>(pages) * static_cast<uint64_t>(pageSize) / (1024 * 1024);
+#endif
+}
+
+// Largest Hash worth giving one engine: a game searches for seconds at most,
+// and spares (analysis, speculation) for less, so more would sit unused.
+// setOption also clamps to the maximum the engine advertises.
+const int64_t MAX_GAME_HASH_MB = 1024;
+const int64_t MAX_SPARE_HASH_MB = 256;
+
+// One hardware thread stays with the UI; the rest are split evenly across
+// the engines. A quarter of free memory goes to Hash: half of it to the
+// game's engine and the other half split across the spares, each capped as
+// above. Hash is rounded down to a power of two, which every Stockfish
+// version accepts.
+inline EngineResources planEngineResources(int engines, bool game) {
+    EngineResources plan;
+    plan.engines = engines < 1 ? 1 : engines;
+    plan.game = game;
+    plan.hardwareThreads = std::thread::hardware_concurrency();
+    plan.availableMb = availableMemoryMb();
+
+    int spare = plan.hardwareThreads > 1 ? static_cast<int>(plan.hardwareThreads) - 1 : 1;
+    plan.threads = spare / plan.engines > 0 ? spare / plan.engines : 1;
+
+    const int64_t MIN_HASH_MB = 16;
+    int64_t budget = static_cast<int64_t>(plan.availableMb / 4);
+    int64_t share;
+    if (plan.engines == 1) share = budget;
+    else if (game) share = budget / 2;
+    else share = budget / 2 / (plan.engines - 1);
+    int64_t cap = game ? MAX_GAME_HASH_MB : MAX_SPARE_HASH_MB;
+    if (share > cap) share = cap;
+
+    int64_t hash = MIN_HASH_MB;
+    while (hash * 2 <= share) hash *= 2;
+    plan.hashMb = hash;
+    return plan;
+}
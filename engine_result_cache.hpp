@@ -0,0 +1,327 @@
+// engine_result_cache.hpp
+#pragma once
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "chess_position.hpp"
+#include "uci_parser.hpp"
+#include "search_limits.hpp"
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+// What a finished search produced, as the cache keeps it.
+struct CachedResult {
+    UciMove move = UCI_MOVE_NONE;
+    UciMove ponder = UCI_MOVE_NONE;
+    UciScore score;
+};
+
+// Where a game stands, as the cache keys it: the position's path key (see
+// PositionHistory::pathKey) and its halfmove clock. Games build it from the
+// ChessPosition and PositionHistory they keep anyway, so looking up a bot
+// move never replays the game. A pathKey of 0 is unknown: not cached.
+struct ResultCachePosition {
+    uint64_t pathKey = 0;
+    int halfmoves = 0;
+
+    static ResultCachePosition of(const ChessPosition& position, const PositionHistory& history) {
+        ResultCachePosition at;
+        at.pathKey = history.pathKey();
+        at.halfmoves = position.halfmoves();
+        return at;
+    }
+
+    // After `move` is played there; unknown if it is not legal.
+    static ResultCachePosition after(ChessPosition position, PositionHistory history, std::string_view move) {
+        UciMove parsed = parseUciMove(move);
+        if (!position.isLegal(parsed)) return ResultCachePosition();
+        position.play(parsed);
+        history.push(position);
+        return of(position, history);
+    }
+};
+
+struct ResultCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t stores = 0;
+
+    double hitRate() const {
+        return hits + misses == 0 ? 0.0 : static_cast<double>(hits) / (hits + misses);
+    }
+};
+
+// Bestmoves of earlier searches in a memory-mapped file, so replayed
+// openings come back without asking the engine. The file is a header and
+// fixed-size buckets of WAYS entries; a full bucket drops its least
+// recently used entry. Entries carry a checksum, so a torn write from a
+// crash reads as a miss instead of a wrong move.
+class EngineResultCache {
+private:
+    static const uint32_t MAGIC = 0x31435256; // "VRC1"
+    static const uint32_t VERSION = 2;
+    static const size_t WAYS = 4;
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t bucketCount;
+        uint32_t clock; // last stamp handed out, for LRU
+        uint32_t reserved[11];
+    };
+
+    struct Entry {
+        uint64_t key; // 0: empty
+        int32_t score;
+        uint32_t stamp;
+        uint32_t check;
+        UciMove move;
+        UciMove ponder;
+        uint8_t scoreKind;
+        uint8_t reserved[7];
+    };
+
+    static_assert(sizeof(Header) == 64, "cache header layout");
+    static_assert(sizeof(Entry) == 32, "cache entry layout");
+
+    std::mutex mutex;
+    Header* header = nullptr;
+    Entry* entries = nullptr;
+    size_t mappedSize = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = NULL;
+#else
+    int fd = -1;
+#endif
+    std::atomic<uint64_t> hitCount{ 0 };
+    std::atomic<uint64_t> missCount{ 0 };
+    std::atomic<uint64_t> storeCount{ 0 };
+
+    static uint32_t checksum(const Entry& entry) {
+        uint64_t mixed = entry.key ^ (static_cast<uint64_t>(static_cast<uint32_t>(entry.score)) << 7) ^
+            (static_cast<uint64_t>(entry.move) << 32) ^ (static_cast<uint64_t>(entry.ponder) << 48) ^
+            (static_cast<uint64_t>(entry.scoreKind) << 24);
+        mixed *= 0x9E3779B97F4A7C15ull;
+        return static_cast<uint32_t>(mixed >> 32);
+    }
+
+    bool mapFile(const std::string& path, size_t size) {
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+            OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER current;
+        if (!GetFileSizeEx(file, &current)) return false;
+        if (static_cast<uint64_t>(current.QuadPart) != size) {
+            LARGE_INTEGER wanted;
+            wanted.QuadPart = static_cast<LONGLONG>(size);
+            if (!SetFilePointerEx(file, wanted, NULL, FILE_BEGIN) || !SetEndOfFile(file)) return false;
+        }
+        mapping = CreateFileMappingA(file, NULL, PAGE_READWRITE, 0, 0, NULL);
+        if (!mapping) return false;
+        void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+        if (!view) return false;
+#else
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0) return false;
+        if (static_cast<uint64_t>(info.st_size) != size && ftruncate(fd, static_cast<off_t>(size)) != 0) return false;
+        void* view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (view == MAP_FAILED) return false;
+#endif
+        mappedSize = size;
+        header = static_cast<Header*>(view);
+        entries = reinterpret_cast<Entry*>(static_cast<char*>(view) + sizeof(Header));
+        return true;
+    }
+
+    void unmap() {
+#ifdef _WIN32
+        if (header) {
+            FlushViewOfFile(header, 0);
+            UnmapViewOfFile(header);
+        }
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        mapping = NULL;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (header) munmap(header, mappedSize);
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+#endif
+        header = nullptr;
+        entries = nullptr;
+        mappedSize = 0;
+    }
+
+    Entry* bucket(uint64_t key) {
+        return entries + (key % header->bucketCount) * WAYS;
+    }
+
+public:
+    // The game's cache, in the working directory next to the other data files.
+    static EngineResultCache& shared() {
+        static EngineResultCache cache;
+        static std::once_flag opened;
+        std::call_once(opened, [] { cache.open("engine_cache.bin"); });
+        return cache;
+    }
+
+    // FNV-1a over the engine's name, the limits, the Skill Level and where
+    // the game stands: the Zobrist key of the position with those since the
+    // last capture or pawn move, which the engine can still see repeat, and
+    // the halfmove clock. Transpositions hit. Limits the cache cannot replay
+    // (a clock, infinite) and unknown positions give 0: not cached.
+    static uint64_t makeKey(std::string_view engineName, const ResultCachePosition& at, const SearchLimits& limits,
+        int skillLevel) {
+        uint64_t value;
+        switch (limits.mode) {
+        case SearchLimits::Depth: value = static_cast<uint64_t>(limits.depth); break;
+        case SearchLimits::MoveTime: value = static_cast<uint64_t>(limits.moveTimeMs); break;
+        case SearchLimits::Nodes: value = limits.nodes; break;
+        default: return 0;
+        }
+        if (!at.pathKey) return 0;
+
+        uint64_t hash = 14695981039346656037ull;
+        auto mix = [&](const void* data, size_t size) {
+            const unsigned char* bytes = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < size; ++i) hash = (hash ^ bytes[i]) * 1099511628211ull;
+        };
+        mix(engineName.data(), engineName.size());
+        mix("\n", 1);
+        mix(&at.pathKey, sizeof(at.pathKey));
+        mix(&at.halfmoves, sizeof(at.halfmoves));
+        int mode = static_cast<int>(limits.mode);
+        mix(&mode, sizeof(mode));
+        mix(&value, sizeof(value));
+        mix(&skillLevel, sizeof(skillLevel));
+        return hash ? hash : 1;
+    }
+
+    // The same for startpos + `moves`, replaying them, for callers that keep
+    // no position of their own. Move lists that do not replay give 0.
+    static uint64_t makeKey(std::string_view engineName, std::string_view moves, const SearchLimits& limits,
+        int skillLevel) {
+        if (limits.mode != SearchLimits::Depth && limits.mode != SearchLimits::MoveTime &&
+            limits.mode != SearchLimits::Nodes) return 0;
+
+        ChessPosition position;
+        PositionHistory history;
+        history.reset(position);
+        for (size_t at = 0; at < moves.size();) {
+            size_t end = moves.find(' ', at);
+            if (end == std::string_view::npos) end = moves.size();
+            if (end > at) {
+                UciMove move = parseUciMove(moves.substr(at, end - at));
+                if (!position.isLegal(move)) return 0;
+                position.play(move);
+                history.push(position);
+            }
+            at = end + 1;
+        }
+        return makeKey(engineName, ResultCachePosition::of(position, history), limits, skillLevel);
+    }
+
+    EngineResultCache() = default;
+    EngineResultCache(const EngineResultCache&) = delete;
+    EngineResultCache& operator=(const EngineResultCache&) = delete;
+
+    ~EngineResultCache() {
+        close();
+    }
+
+    // Maps `path`, creating it or starting it over when its layout differs.
+    // The cache stays disabled (every lookup misses) if that fails.
+    bool open(const std::string& path, size_t bucketCount = 16384) {
+        std::lock_guard<std::mutex> lock(mutex);
+        unmap();
+        size_t size = sizeof(Header) + bucketCount * WAYS * sizeof(Entry);
+        if (!mapFile(path, size)) {
+            unmap();
+            return false;
+        }
+        if (header->magic != MAGIC || header->version != VERSION || header->bucketCount != bucketCount) {
+            std::memset(header, 0, size);
+            header->magic = MAGIC;
+            header->version = VERSION;
+            header->bucketCount = bucketCount;
+        }
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        unmap();
+    }
+
+    bool isOpen() const {
+        return header != nullptr;
+    }
+
+    bool lookup(uint64_t key, CachedResult& result) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (header && key) {
+            Entry* ways = bucket(key);
+            for (size_t i = 0; i < WAYS; ++i) {
+                Entry& entry = ways[i];
+                if (entry.key != key || entry.check != checksum(entry)) continue;
+                entry.stamp = ++header->clock;
+                result.move = entry.move;
+                result.ponder = entry.ponder;
+                result.score.kind = static_cast<UciScore::Kind>(entry.scoreKind);
+                result.score.value = entry.score;
+                ++hitCount;
+                return true;
+            }
+        }
+        ++missCount;
+        return false;
+    }
+
+    void store(uint64_t key, const CachedResult& result) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!header || !key || result.move == UCI_MOVE_NONE) return;
+
+        Entry* ways = bucket(key);
+        Entry* victim = &ways[0];
+        for (size_t i = 0; i < WAYS; ++i) {
+            if (ways[i].key == key || ways[i].key == 0) {
+                victim = &ways[i];
+                break;
+            }
+            if (ways[i].stamp < victim->stamp) victim = &ways[i];
+        }
+
+        Entry entry = {};
+        entry.key = key;
+        entry.move = result.move;
+        entry.ponder = result.ponder;
+        entry.scoreKind = static_cast<uint8_t>(result.score.kind);
+        entry.score = result.score.value;
+        entry.stamp = ++header->clock;
+        entry.check = checksum(entry);
+        *victim = entry;
+        ++storeCount;
+    }
+
+    ResultCacheStats stats() const {
+        ResultCacheStats counters;
+        counters.hits = hitCount.load();
+        counters.misses = missCount.load();
+        counters.stores = storeCount.load();
+        return counters;
+    }
+};
@@ -0,0 +1,104 @@
+// engine_scheduling.hpp
+#pragma once
+#ifdef __linux__
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Which cores engines and the render loop run on. Engines get every core
+// but the UI's, at a higher nice value, so a busy search cannot take the
+// frame loop's core away. With a single core only the nice value applies.
+// Only applied on Linux; elsewhere it is inert.
+struct EngineSchedulingPolicy {
+    bool enabled = false;
+    int uiCore = 0;
+    std::vector<int> engineCores; // empty: every core except uiCore
+    int niceIncrement = 5;        // added to the spawning thread's nice value
+
+    bool pinsCores() const {
+        return enabled && (!engineCores.empty() || std::thread::hardware_concurrency() >= 2);
+    }
+
+    std::string describe() const {
+        if (!enabled) return "off";
+        if (!pinsCores()) return "engines at nice +" + std::to_string(niceIncrement) + " (one core, nothing to pin)";
+        std::string cores;
+        for (int core : engineCores) cores += (cores.empty() ? "" : ",") + std::to_string(core);
+        return "UI on core " + std::to_string(uiCore) + ", engines on " +
+            (cores.empty() ? "the other cores" : "cores " + cores) + " at nice +" + std::to_string(niceIncrement);
+    }
+};
+
+// On unless $VIBE_CHESS_SCHEDULING is "off".
+inline EngineSchedulingPolicy defaultEngineSchedulingPolicy() {
+    EngineSchedulingPolicy policy;
+#ifdef __linux__
+    const char* setting = getenv("VIBE_CHESS_SCHEDULING");
+    policy.enabled = !(setting && strcmp(setting, "off") == 0);
+#endif
+    return policy;
+}
+
+// Process-wide; change it before engines are spawned.
+inline EngineSchedulingPolicy& engineSchedulingPolicy() {
+    static EngineSchedulingPolicy policy = defaultEngineSchedulingPolicy();
+    return policy;
+}
+
+// Moves the calling thread onto the engine cores at the engine nice value.
+// A process spawned from that thread, and every thread it starts, inherits
+// both, which is why PipeBackend spawns from a throwaway thread.
+inline bool applyEngineScheduling(const EngineSchedulingPolicy& policy) {
+#ifdef __linux__
+    if (!policy.enabled) return false;
+    bool pinned = true;
+    if (policy.pinsCores()) {
+        cpu_set_t cores;
+        CPU_ZERO(&cores);
+        if (policy.engineCores.empty()) {
+            unsigned count = std::thread::hardware_concurrency();
+            for (unsigned core = 0; core < count && core < CPU_SETSIZE; ++core) {
+                if (static_cast<int>(core) != policy.uiCore) CPU_SET(core, &cores);
+            }
+        }
+        else {
+            for (int core : policy.engineCores) {
+                if (core >= 0 && core < CPU_SETSIZE) CPU_SET(core, &cores);
+            }
+        }
+        pinned = CPU_COUNT(&cores) > 0 && sched_setaffinity(0, sizeof(cores), &cores) == 0;
+    }
+
+    // Nice values are per thread on Linux.
+    id_t thread = static_cast<id_t>(syscall(SYS_gettid));
+    int nice = getpriority(PRIO_PROCESS, thread) + policy.niceIncrement;
+    bool reniced = setpriority(PRIO_PROCESS, thread, nice > 19 ? 19 : nice) == 0;
+    return pinned && reniced;
+#else
+    (void)policy;
+    return false;
+#endif
+}
+
+// Pins the calling thread, meant to be the render loop, to the UI core.
+// Threads it starts afterwards inherit the pin, which suits the light
+// helpers (pool worker, reactor, audio); engines are moved off it at spawn.
+inline bool reserveUiCore(const EngineSchedulingPolicy& policy) {
+#ifdef __linux__
+    if (!policy.pinsCores() || policy.uiCore < 0 || policy.uiCore >= CPU_SETSIZE) return false;
+    cpu_set_t cores;
+    CPU_ZERO(&cores);
+    CPU_SET(policy.uiCore, &cores);
+    return sched_setaffinity(0, sizeof(cores), &cores) == 0;
+#else
+    (void)policy;
+    return false;
+#endif
+}
@@ -0,0 +1,291 @@
+// engine_speculation.hpp
+#pragma once
+#include "engine_pool.hpp"
+#include "search_limits.hpp"
+#include "uci_parser.hpp"
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+const int SPECULATION_MAX_WIDTH = 7; // one MultiPV line is kept for the excluded move
+
+// Per difficulty level, so k can be tuned per level. Times are wall-clock
+// milliseconds of engine searching, summed over engines.
+struct SpeculationStats {
+    uint64_t rounds = 0;     // player moves a speculation was running for
+    uint64_t hits = 0;       // the player's move had a branch
+    uint64_t branches = 0;   // reply searches started
+    uint64_t candidateMs = 0; // finding the player's likely moves
+    uint64_t usefulMs = 0;   // searching the branch the player then played
+    uint64_t wastedMs = 0;   // searching branches nobody played
+
+    double hitRate() const {
+        return rounds == 0 ? 0.0 : static_cast<double>(hits) / rounds;
+    }
+
+    double wastedShare() const {
+        uint64_t total = candidateMs + usefulMs + wastedMs;
+        return total == 0 ? 0.0 : static_cast<double>(candidateMs + wastedMs) / total;
+    }
+};
+
+// While the player thinks, asks a spare pooled engine for their k most
+// likely moves (a short MultiPV search) and then searches the bot's reply
+// to each on its own pooled engine. resolve() hands the game the branch
+// matching the move actually played, finished or still running. Driven from
+// the frame loop like EngineAnalysis; engines are only ever taken with
+// acquire(0), so a busy pool makes it speculate less, never stall.
+class EngineSpeculation {
+private:
+    struct Branch {
+        std::string move; // the player's candidate
+        ResultCachePosition at; // where the game stands after it
+        size_t engine = 0;
+        unsigned searchId = 0;
+        bool started = false;
+        bool finished = false;
+        bool handedOver = false; // now the game's bot move; no longer polled here
+        std::string reply;
+        std::string ponder;
+        std::chrono::steady_clock::time_point startedAt;
+        std::chrono::steady_clock::time_point endedAt;
+    };
+
+    int level;
+    size_t width;
+    SearchLimits candidateLimits;
+    std::vector<std::unique_ptr<EngineLease>> engines;
+    std::vector<bool> busy;
+
+    enum Phase { Idle, WaitingForEngine, FindingCandidates, Replying };
+
+    Phase phase = Idle;
+    std::string position;
+    ChessPosition board;     // `position` played out, to key each branch's result
+    PositionHistory history;
+    std::string excluded;
+    SearchLimits replyLimits;
+    size_t candidateEngine = 0;
+    unsigned candidateId = 0;
+    std::chrono::steady_clock::time_point candidatesStartedAt;
+    uint64_t candidateMs = 0;
+    UciMove candidates[SPECULATION_MAX_WIDTH + 1];
+    std::vector<Branch> branches;
+
+    static std::mutex& statsMutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    static std::map<int, SpeculationStats>& statsByLevel() {
+        static std::map<int, SpeculationStats> stats;
+        return stats;
+    }
+
+    static uint64_t millisBetween(std::chrono::steady_clock::time_point from,
+        std::chrono::steady_clock::time_point to) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(to - from).count();
+    }
+
+    // Index of an engine not searching anything, taking one from the pool if
+    // it has one idle right now; engines.size() if there is none.
+    size_t freeEngine() {
+        for (size_t i = 0; i < engines.size(); ++i) {
+            if (!busy[i]) return i;
+        }
+        if (engines.size() >= width) return engines.size();
+        std::unique_ptr<ChessEngine> engine = EnginePool::instance().acquire(0);
+        if (!engine) return engines.size();
+        engine->setResultCache(&EngineResultCache::shared());
+        engines.emplace_back(new EngineLease(std::move(engine)));
+        busy.push_back(false);
+        return engines.size() - 1;
+    }
+
+    void startCandidates() {
+        size_t index = freeEngine();
+        if (index == engines.size()) return;
+
+        ChessEngine& engine = **engines[index];
+        engine.setDifficulty(20); // the player's best moves, not the bot's
+        engine.setMultiPv(static_cast<int>(width + (excluded.empty() ? 0 : 1)));
+        candidateEngine = index;
+        candidateId = engine.startSearch(position, candidateLimits);
+        busy[index] = true;
+        phase = FindingCandidates;
+        candidatesStartedAt = std::chrono::steady_clock::now();
+        for (UciMove& move : candidates) move = UCI_MOVE_NONE;
+    }
+
+    void pollCandidates() {
+        ChessEngine& engine = **engines[candidateEngine];
+        std::string best, ponder;
+        bool done = engine.pollSearch(candidateId, best, ponder, [this](const UciInfo& info) {
+            if (info.pvLength > 0 && info.multipv >= 1 && info.multipv <= SPECULATION_MAX_WIDTH + 1) {
+                candidates[info.multipv - 1] = info.pv[0];
+            }
+        });
+        if (!done) return;
+
+        phase = Replying;
+        busy[candidateEngine] = false;
+        candidateMs = millisBetween(candidatesStartedAt, std::chrono::steady_clock::now());
+        engine.setMultiPv(1);
+        for (UciMove candidate : candidates) {
+            std::string move = uciMoveToString(candidate);
+            if (move.empty() || move == excluded || branches.size() >= width) continue;
+            Branch branch;
+            branch.move = move;
+            branch.at = ResultCachePosition::after(board, history, move);
+            branches.push_back(branch);
+        }
+    }
+
+    void startBranches() {
+        for (Branch& branch : branches) {
+            if (branch.started) continue;
+            size_t index = freeEngine();
+            if (index == engines.size()) return;
+
+            ChessEngine& engine = **engines[index];
+            engine.setDifficulty(level);
+            branch.engine = index;
+            branch.searchId = engine.startSearch(position.empty() ? branch.move : position + " " + branch.move,
+                replyLimits, branch.at);
+            branch.started = true;
+            branch.startedAt = std::chrono::steady_clock::now();
+            busy[index] = true;
+        }
+    }
+
+    void pollBranches() {
+        for (Branch& branch : branches) {
+            if (!branch.started || branch.finished || branch.handedOver) continue;
+            if ((*engines[branch.engine])->pollSearch(branch.searchId, branch.reply, branch.ponder)) {
+                branch.finished = true;
+                branch.endedAt = std::chrono::steady_clock::now();
+                busy[branch.engine] = false;
+            }
+        }
+    }
+
+    // Stops everything but `keep` and books the round's engine time.
+    void finishRound(const Branch* keep, bool counted) {
+        auto now = std::chrono::steady_clock::now();
+        if (phase == FindingCandidates) {
+            (*engines[candidateEngine])->stopSearch(candidateId);
+            (*engines[candidateEngine])->setMultiPv(1);
+            candidateMs = millisBetween(candidatesStartedAt, now);
+        }
+
+        SpeculationStats round;
+        round.candidateMs = candidateMs;
+        for (Branch& branch : branches) {
+            if (!branch.started) continue;
+            ++round.branches;
+            // A handed-over branch still searching is booked up to now.
+            if (!branch.finished) {
+                if (&branch != keep) (*engines[branch.engine])->stopSearch(branch.searchId);
+                branch.endedAt = now;
+            }
+            uint64_t ms = millisBetween(branch.startedAt, branch.endedAt);
+            if (&branch == keep) round.usefulMs += ms;
+            else round.wastedMs += ms;
+        }
+        for (size_t i = 0; i < busy.size(); ++i) busy[i] = false;
+
+        if (counted) {
+            std::lock_guard<std::mutex> lock(statsMutex());
+            SpeculationStats& stats = statsByLevel()[level];
+            ++stats.rounds;
+            if (keep) ++stats.hits;
+            stats.branches += round.branches;
+            stats.candidateMs += round.candidateMs;
+            stats.usefulMs += round.usefulMs;
+            stats.wastedMs += round.wastedMs;
+        }
+        branches.clear();
+        candidateMs = 0;
+        phase = Idle;
+    }
+
+public:
+    // k = `width` branches at most; candidateLimits bounds the search that
+    // picks them.
+    EngineSpeculation(int level, int width, const SearchLimits& candidateLimits = SearchLimits::fixedDepth(8))
+        : level(level), width(width < 0 ? 0 : width > SPECULATION_MAX_WIDTH ? SPECULATION_MAX_WIDTH : width),
+        candidateLimits(candidateLimits) {}
+
+    EngineSpeculation(const EngineSpeculation&) = delete;
+    EngineSpeculation& operator=(const EngineSpeculation&) = delete;
+
+    ~EngineSpeculation() {
+        cancel();
+    }
+
+    static SpeculationStats stats(int level) {
+        std::lock_guard<std::mutex> lock(statsMutex());
+        auto it = statsByLevel().find(level);
+        return it == statsByLevel().end() ? SpeculationStats() : it->second;
+    }
+
+    // Starts speculating on startpos + moves with the player to move; the
+    // game's `board` and `history` stand after those moves. `excludedMove` is
+    // one already covered elsewhere (the ponder move).
+    void start(const std::string& moves, const ChessPosition& board, const PositionHistory& history,
+        const SearchLimits& limits, const std::string& excludedMove = "") {
+        cancel();
+        if (width == 0) return;
+        position = moves;
+        this->board = board;
+        this->history = history;
+        excluded = excludedMove;
+        replyLimits = limits;
+        phase = WaitingForEngine;
+        startCandidates();
+    }
+
+    void poll() {
+        if (phase == WaitingForEngine) startCandidates();
+        if (phase == FindingCandidates) pollCandidates();
+        if (phase == Replying) {
+            startBranches();
+            pollBranches();
+        }
+    }
+
+    // The bot's reply to `playedMove` if it was speculated on: already
+    // finished or still searching on a speculation engine. Invalid on a miss.
+    // Either way every other branch is stopped.
+    BestMoveFuture resolve(const std::string& playedMove) {
+        if (phase == Idle) return BestMoveFuture();
+        poll();
+
+        Branch* match = nullptr;
+        for (Branch& branch : branches) {
+            if (branch.started && branch.move == playedMove) match = &branch;
+        }
+
+        BestMoveFuture reply;
+        if (match) {
+            ChessEngine& engine = **engines[match->engine];
+            if (match->finished) {
+                reply = BestMoveFuture(engine, match->reply, match->ponder);
+            }
+            else {
+                match->handedOver = true;
+                reply = BestMoveFuture(engine, match->searchId);
+            }
+        }
+        finishRound(match, true);
+        return reply;
+    }
+
+    // Drops the round without counting it, e.g. when pondering already hit.
+    void cancel() {
+        if (phase != Idle) finishRound(nullptr, false);
+    }
+};
@@ -0,0 +1,97 @@
+// histogram.hpp
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Log-linear histogram in the style of HdrHistogram: values below 64 are
+// counted exactly, larger ones in 32 linear sub-buckets per power of two,
+// so any percentile is within ~3% of the true value. Recording is O(1) and
+// never allocates after construction.
+class Histogram {
+private:
+    static const int SUB_BUCKETS = 32;
+    static const int LINEAR_LIMIT = 2 * SUB_BUCKETS; // values below are exact
+    static const int BUCKET_COUNT = LINEAR_LIMIT + (63 - 5) * SUB_BUCKETS;
+
+    std::vector<uint64_t> counts;
+    uint64_t total = 0;
+    uint64_t minValue = UINT64_MAX;
+    uint64_t maxValue = 0;
+    double sum = 0;
+
+    static int highestBit(uint64_t value) {
+#if defined(_MSC_VER) && defined(_M_X64)
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return static_cast<int>(index);
+#elif defined(_MSC_VER)
+        // 32-bit MSVC only scans 32-bit words: the high half, then the low one.
+        unsigned long index;
+        if (_BitScanReverse(&index, static_cast<uint32_t>(value >> 32))) return static_cast<int>(index) + 32;
+        _BitScanReverse(&index, static_cast<uint32_t>(value));
+        return static_cast<int>(index);
+#else
+        return 63 - __builtin_clzll(value);
+#endif
+    }
+
+    static int indexOf(uint64_t value) {
+        if (value < LINEAR_LIMIT) return static_cast<int>(value);
+        int shift = highestBit(value) - 5; // value >> shift lands in [32, 63]
+        return LINEAR_LIMIT + (shift - 1) * SUB_BUCKETS + static_cast<int>(value >> shift) - SUB_BUCKETS;
+    }
+
+    // Midpoint of the range a bucket covers.
+    static uint64_t valueAt(int index) {
+        if (index < LINEAR_LIMIT) return static_cast<uint64_t>(index);
+        int shift = (index - LINEAR_LIMIT) / SUB_BUCKETS + 1;
+        uint64_t low = static_cast<uint64_t>((index - LINEAR_LIMIT) % SUB_BUCKETS + SUB_BUCKETS) << shift;
+        return low + (uint64_t(1) << shift) / 2;
+    }
+
+public:
+    Histogram() : counts(BUCKET_COUNT) {}
+
+    void record(uint64_t value) {
+        ++counts[indexOf(value)];
+        ++total;
+        sum += static_cast<double>(value);
+        if (value < minValue) minValue = value;
+        if (value > maxValue) maxValue = value;
+    }
+
+    uint64_t count() const { return total; }
+    uint64_t minimum() const { return total ? minValue : 0; } // not min/max: windows.h macros
+    uint64_t maximum() const { return maxValue; }
+    double mean() const { return total ? sum / total : 0.0; }
+
+    // percent in [0, 100]; 0 when nothing was recorded.
+    uint64_t percentile(double percent) const {
+        if (total == 0) return 0;
+        uint64_t rank = static_cast<uint64_t>(percent / 100.0 * total + 0.5);
+        if (rank < 1) rank = 1;
+        if (rank > total) rank = total;
+
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKET_COUNT; ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                uint64_t value = valueAt(i);
+                return value < minValue ? minValue : value > maxValue ? maxValue : value;
+            }
+        }
+        return maxValue;
+    }
+
+    void reset() {
+        std::fill(counts.begin(), counts.end(), 0);
+        total = 0;
+        minValue = UINT64_MAX;
+        maxValue = 0;
+        sum = 0;
+    }
+};
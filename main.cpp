@@ -1,9 +1,17 @@
 #include <SFML/Graphics.hpp>
 #include "menu.h"
+#include "engine_metrics.hpp"
+#include "engine_scheduling.hpp"
+#include <iostream>
 
 int main() {
+    // Before any thread starts, so SFML's and ours inherit the UI core.
+    reserveUiCore(engineSchedulingPolicy());
+    std::cout << "Scheduling: " << engineSchedulingPolicy().describe() << std::endl;
+
     sf::RenderWindow window(sf::VideoMode(1920, 1080), "Tactics Royale", sf::Style::Close);
     window.setFramerateLimit(60);
     startGame(window);
+    EngineMetrics::instance().writeCsv("engine_metrics.csv");
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,84 @@
+// search_limits.hpp
+#pragma once
+#include <cstdint>
+#include <string>
+
+// How far a bot search may go, rendered as the arguments of "go".
+struct SearchLimits {
+    enum Mode { Depth, MoveTime, Nodes, Clock, Infinite };
+
+    Mode mode = Depth;
+    int depth = 10;
+    int moveTimeMs = 0;
+    uint64_t nodes = 0;
+    int whiteTimeMs = 0;
+    int blackTimeMs = 0;
+    int whiteIncrementMs = 0;
+    int blackIncrementMs = 0;
+
+    static SearchLimits fixedDepth(int depth) {
+        SearchLimits limits;
+        limits.mode = Depth;
+        limits.depth = depth;
+        return limits;
+    }
+
+    static SearchLimits fixedMoveTime(int moveTimeMs) {
+        SearchLimits limits;
+        limits.mode = MoveTime;
+        limits.moveTimeMs = moveTimeMs;
+        return limits;
+    }
+
+    static SearchLimits fixedNodes(uint64_t nodes) {
+        SearchLimits limits;
+        limits.mode = Nodes;
+        limits.nodes = nodes;
+        return limits;
+    }
+
+    // Runs until stopped; for analysis, never for the bot.
+    static SearchLimits infinite() {
+        SearchLimits limits;
+        limits.mode = Infinite;
+        return limits;
+    }
+
+    // `nodes`, when set, caps the search however much time the clock allows.
+    static SearchLimits clock(int whiteTimeMs, int blackTimeMs, int whiteIncrementMs, int blackIncrementMs,
+        uint64_t nodes = 0) {
+        SearchLimits limits;
+        limits.mode = Clock;
+        limits.whiteTimeMs = whiteTimeMs;
+        limits.blackTimeMs = blackTimeMs;
+        limits.whiteIncrementMs = whiteIncrementMs;
+        limits.blackIncrementMs = blackIncrementMs;
+        limits.nodes = nodes;
+        return limits;
+    }
+
+    // With ponder set the search runs in ponder mode until "ponderhit".
+    std::string goCommand(bool ponder = false) const {
+        std::string go = ponder ? "go ponder " : "go ";
+        switch (mode) {
+        case MoveTime:
+            return go + "movetime " + std::to_string(moveTimeMs);
+        case Nodes:
+            return go + "nodes " + std::to_string(nodes);
+        case Clock:
+            return go + "wtime " + std::to_string(whiteTimeMs) + " btime " + std::to_string(blackTimeMs) +
+                " winc " + std::to_string(whiteIncrementMs) + " binc " + std::to_string(blackIncrementMs) +
+                (nodes > 0 ? " nodes " + std::to_string(nodes) : "");
+        case Infinite:
+            return go + "infinite";
+        default:
+            return go + "depth " + std::to_string(depth);
+        }
+    }
+
+    // Wall time after which the search is told to stop, or 0 for no budget.
+    // Engines honour movetime themselves; this only catches ones that overrun.
+    int latencyBudgetMs() const {
+        return mode == MoveTime ? moveTimeMs + 250 : 0;
+    }
+};
@@ -0,0 +1,25 @@
+// bench.h
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+// Each benchmark is a subcommand of the bench tool: `bench <name> [args]`.
+int benchUciParser(int argc, char** argv);
+int benchReactor(int argc, char** argv);
+int benchFrames(int argc, char** argv);
+int benchLevels(int argc, char** argv);
+int benchMovegen(int argc, char** argv);
+int benchAttacks(int argc, char** argv);
+int benchAnalysis(int argc, char** argv);
+int benchReaper(int argc, char** argv);
+
+inline double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Keeps results alive so the optimizer cannot drop the measured work.
+inline void doNotOptimize(uint64_t value) {
+    static volatile uint64_t sink;
+    sink = value;
+    (void)sink;
+}
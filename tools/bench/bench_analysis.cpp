@@ -0,0 +1,106 @@
+#include "bench.h"
+#include "../../engine_analysis.hpp"
+#include "../../chess_position.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+// Drives EngineAnalysis the way a frame loop would, polling every
+// millisecond, and checks every snapshot it produces: the lines are
+// numbered from 1 without gaps, each starts with a legal move, no two start
+// with the same one, and a limited search finishes with a legal bestmove.
+// Reports what a poll costs and how often the snapshot changes.
+static bool checkSnapshot(const AnalysisSnapshot& snapshot, const ChessPosition& position, int lines,
+    std::string& problem) {
+    if (snapshot.lineCount > lines) {
+        problem = "more lines than asked for";
+        return false;
+    }
+    for (int i = 0; i < snapshot.lineCount; ++i) {
+        const UciInfo& line = snapshot.lines[i];
+        if (line.multipv != i + 1 || line.pvLength == 0) {
+            problem = "line " + std::to_string(i + 1) + " is missing or out of place";
+            return false;
+        }
+        if (!position.isLegal(line.pv[0])) {
+            problem = "line " + std::to_string(i + 1) + " starts with " + uciMoveToString(line.pv[0]) + ", not a legal move";
+            return false;
+        }
+        for (int j = 0; j < i; ++j) {
+            if (snapshot.lines[j].pv[0] == line.pv[0]) {
+                problem = "lines " + std::to_string(j + 1) + " and " + std::to_string(i + 1) + " start with the same move";
+                return false;
+            }
+        }
+    }
+    if (snapshot.finished && !position.isLegal(snapshot.bestMove)) {
+        problem = "bestmove is not a legal move";
+        return false;
+    }
+    return true;
+}
+
+int benchAnalysis(int argc, char** argv) {
+    std::string narrow = argc >= 1 ? argv[0] : "mock_engine";
+    std::wstring path(narrow.begin(), narrow.end());
+    double seconds = argc >= 2 ? std::atof(argv[1]) : 2.0;
+    if (seconds <= 0) seconds = 2.0;
+    int lines = argc >= 3 ? std::atoi(argv[2]) : 3;
+    if (lines < 1 || lines > ANALYSIS_MAX_LINES) lines = 3;
+
+    const char* const OPENING = "e2e4 e7e5 g1f3 b8c6 f1b5";
+    ChessPosition position;
+    position.playMoves(OPENING);
+    EnginePool::instance().warmUp(1, path);
+
+    // An infinite analysis, stopped from outside as the UI would.
+    EngineAnalysis analysis;
+    analysis.start(OPENING, lines);
+    uint64_t polls = 0, updates = 0;
+    double pollSeconds = 0;
+    std::string problem;
+    auto start = std::chrono::steady_clock::now();
+    while (secondsSince(start) < seconds) {
+        auto before = std::chrono::steady_clock::now();
+        bool changed = analysis.poll();
+        pollSeconds += secondsSince(before);
+        ++polls;
+        if (changed) {
+            ++updates;
+            if (!checkSnapshot(analysis.snapshot(), position, lines, problem)) break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    analysis.stop();
+    AnalysisSnapshot infinite = analysis.snapshot();
+    if (problem.empty() && infinite.lineCount != lines) {
+        problem = "got " + std::to_string(infinite.lineCount) + " lines, asked for " + std::to_string(lines);
+    }
+    if (problem.empty() && infinite.finished) problem = "an infinite analysis finished by itself";
+
+    // A node-limited one has to finish by itself with a bestmove.
+    if (problem.empty()) {
+        analysis.start(OPENING, lines, SearchLimits::fixedNodes(20000));
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (!analysis.snapshot().finished && std::chrono::steady_clock::now() < deadline) {
+            if (analysis.poll() && !checkSnapshot(analysis.snapshot(), position, lines, problem)) break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        if (problem.empty() && !analysis.snapshot().finished) problem = "a node-limited analysis never finished";
+    }
+
+    std::cout << "analysis: " << lines << " lines for " << seconds << " s, " << updates << " snapshot updates ("
+        << static_cast<uint64_t>(updates / seconds) << "/s), poll " << pollSeconds * 1e6 / polls << " us\n";
+    for (int i = 0; i < infinite.lineCount; ++i) {
+        const UciInfo& line = infinite.lines[i];
+        std::cout << "  " << line.multipv << ". " << uciMoveToString(line.pv[0]) << " depth " << line.depth
+            << " score " << line.score.value << "\n";
+    }
+    if (!problem.empty()) {
+        std::cout << "  FAILED: " << problem << "\n";
+        return 1;
+    }
+    std::cout << "  every snapshot checked, bestmove " << uciMoveToString(analysis.snapshot().bestMove) << "\n";
+    return 0;
+}
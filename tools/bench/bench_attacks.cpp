@@ -0,0 +1,90 @@
+#include "bench.h"
+#include "../../bitboard.hpp"
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Queen attacks (rook | bishop) for random squares and occupancies, three
+// ways: walking the rays of an int layout[8][8] the way the game's board
+// would have to, magic multiplication, and PEXT where the CPU has BMI2.
+struct AttackQuery {
+    int square;
+    Bitboard occupied;
+    int layout[8][8]; // layout[0] is rank 8, as in the game
+};
+
+static Bitboard walkLayout(const int layout[8][8], int square) {
+    const int STEPS[8][2] = { {0, 1}, {1, 0}, {0, -1}, {-1, 0}, {1, 1}, {-1, 1}, {1, -1}, {-1, -1} };
+    Bitboard attacks = 0;
+    for (const auto& step : STEPS) {
+        int file = (square & 7) + step[0], rank = (square >> 3) + step[1];
+        while (file >= 0 && file < 8 && rank >= 0 && rank < 8) {
+            attacks |= squareBit(rank * 8 + file);
+            if (layout[7 - rank][file]) break;
+            file += step[0];
+            rank += step[1];
+        }
+    }
+    return attacks;
+}
+
+template <typename Lookup>
+static double nanosPerLookup(const std::vector<AttackQuery>& queries, double seconds, Lookup&& lookup) {
+    uint64_t checksum = 0, lookups = 0;
+    auto start = std::chrono::steady_clock::now();
+    double elapsed = 0;
+    while (elapsed < seconds) {
+        for (const AttackQuery& query : queries) checksum += lookup(query);
+        lookups += queries.size();
+        elapsed = secondsSince(start);
+    }
+    doNotOptimize(checksum);
+    return elapsed * 1e9 / lookups;
+}
+
+int benchAttacks(int argc, char** argv) {
+    double seconds = argc >= 1 ? std::atof(argv[0]) : 3.0;
+    if (seconds <= 0) seconds = 3.0;
+
+    // A quarter to a half of the board occupied, like a middlegame.
+    std::mt19937_64 rng(4242);
+    std::vector<AttackQuery> queries(1024);
+    for (AttackQuery& query : queries) {
+        query.square = static_cast<int>(rng() & 63);
+        query.occupied = (rng() & rng()) | (rng() & rng() & rng());
+        for (int square = 0; square < 64; ++square) {
+            query.layout[7 - (square >> 3)][square & 7] = (query.occupied >> square) & 1;
+        }
+    }
+
+    int methods = 2;
+#ifdef BITBOARD_PEXT_AVAILABLE
+    if (BITBOARD_CPU_HAS_BMI2) methods = 3;
+#endif
+    double slice = seconds / methods;
+
+    double naive = nanosPerLookup(queries, slice, [](const AttackQuery& q) {
+        return walkLayout(q.layout, q.square);
+    });
+    double magic = nanosPerLookup(queries, slice, [](const AttackQuery& q) {
+        return magicSliderAttacks(SLIDER_ROOK, q.square, q.occupied) | magicSliderAttacks(SLIDER_BISHOP, q.square, q.occupied);
+    });
+
+    std::cout << "attacks: queen attack sets, " << queries.size() << " random squares and occupancies\n"
+        << std::fixed << std::setprecision(2)
+        << "  layout ray walk  " << std::setw(8) << naive << " ns\n"
+        << "  magic            " << std::setw(8) << magic << " ns  (" << naive / magic << "x)\n";
+#ifdef BITBOARD_PEXT_AVAILABLE
+    if (BITBOARD_CPU_HAS_BMI2) {
+        double pext = nanosPerLookup(queries, slice, [](const AttackQuery& q) {
+            return pextSliderAttacks(SLIDER_ROOK, q.square, q.occupied) | pextSliderAttacks(SLIDER_BISHOP, q.square, q.occupied);
+        });
+        std::cout << "  pext             " << std::setw(8) << pext << " ns  (" << naive / pext << "x)"
+            << (BITBOARD_USE_PEXT ? ", in use" : ", not inlined in this build, magic in use") << "\n";
+    }
+#endif
+    if (methods == 2) std::cout << "  (no BMI2: PEXT not measured)\n";
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include "bench.h"
+#include "../../engine_backend.hpp"
+#include "../../histogram.hpp"
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+// A 60 Hz frame loop doing a fixed amount of work per frame while an engine
+// keeps every core busy, once with the scheduling policy off and once on.
+// Frame time is start-to-start; anything past 20 ms is a dropped frame.
+struct FrameRun {
+    Histogram frameUs;
+    uint64_t late = 0;
+};
+
+static uint64_t spin(uint64_t iterations) {
+    uint64_t work = 0;
+    for (uint64_t i = 0; i < iterations; ++i) work = work * 6364136223846793005ull + 1;
+    return work;
+}
+
+// Iterations of spin() taking `ms` on an idle machine.
+static uint64_t calibrate(int ms) {
+    uint64_t iterations = 1 << 16;
+    while (true) {
+        auto start = std::chrono::steady_clock::now();
+        doNotOptimize(spin(iterations));
+        double seconds = secondsSince(start);
+        if (seconds > 0.05) return static_cast<uint64_t>(iterations * (ms / 1000.0) / seconds);
+        iterations *= 2;
+    }
+}
+
+static bool runFrames(const std::wstring& path, bool policyOn, int busyThreads, double seconds,
+    uint64_t frameWork, FrameRun& run) {
+    EngineSchedulingPolicy& policy = engineSchedulingPolicy();
+    policy.enabled = policyOn;
+    bool ok = true;
+
+    // Its own thread, so pinning it to the UI core does not stick to main.
+    std::thread ui([&] {
+        if (policyOn) reserveUiCore(policy);
+
+        UciLineQueue lines;
+        lines.reset();
+        PipeBackend engine;
+        if (!engine.start(path, lines)) {
+            ok = false;
+            return;
+        }
+        std::string setup = "uci\nsetoption name Busy Threads value " + std::to_string(busyThreads) +
+            "\nsetoption name Info Rate value 10\nposition startpos\ngo infinite\n";
+        engine.write(setup.data(), setup.size());
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+        const auto FRAME = std::chrono::microseconds(16667);
+        std::string line;
+        auto start = std::chrono::steady_clock::now();
+        auto frameStart = start;
+        auto nextFrame = start + FRAME;
+        while (secondsSince(start) < seconds) {
+            while (lines.tryPop(line)) {}
+            doNotOptimize(spin(frameWork));
+            std::this_thread::sleep_until(nextFrame);
+
+            auto now = std::chrono::steady_clock::now();
+            uint64_t us = std::chrono::duration_cast<std::chrono::microseconds>(now - frameStart).count();
+            run.frameUs.record(us);
+            if (us > 20000) ++run.late;
+            frameStart = now;
+            nextFrame += FRAME;
+            if (nextFrame < now) nextFrame = now + FRAME; // behind: skip, do not burst
+        }
+
+        const char stop[] = "stop\n";
+        engine.write(stop, sizeof(stop) - 1);
+        engine.shutdown(1000);
+    });
+    ui.join();
+    return ok;
+}
+
+int benchFrames(int argc, char** argv) {
+    std::string narrow = argc >= 1 ? argv[0] : "mock_engine";
+    std::wstring path(narrow.begin(), narrow.end());
+    double seconds = argc >= 2 ? std::atof(argv[1]) : 5.0;
+    unsigned cores = std::thread::hardware_concurrency();
+    int busyThreads = argc >= 3 ? std::atoi(argv[2]) : static_cast<int>(cores > 0 ? cores : 1);
+    if (seconds <= 0) seconds = 5.0;
+
+    uint64_t frameWork = calibrate(4);
+    std::cout << "frames: 60 Hz, 4 ms of work per frame, engine burning " << busyThreads << " thread(s) on "
+        << cores << " core(s), " << seconds << " s per run\n";
+    if (cores < 2) std::cout << "  (one core: only the engine's nice value differs between the runs)\n";
+    std::cout << "  policy      p50 ms    p99 ms    max ms   dropped\n";
+
+    for (int mode = 0; mode < 2; ++mode) {
+        bool policyOn = mode == 1;
+        FrameRun run;
+        if (!runFrames(path, policyOn, busyThreads, seconds, frameWork, run)) {
+            std::cerr << "frames: could not start the engine\n";
+            return 1;
+        }
+        std::cout << "  " << std::left << std::setw(8) << (mode == 1 ? "on" : "off") << std::right
+            << std::fixed << std::setprecision(2)
+            << std::setw(10) << run.frameUs.percentile(50) / 1000.0
+            << std::setw(10) << run.frameUs.percentile(99) / 1000.0
+            << std::setw(10) << run.frameUs.maximum() / 1000.0
+            << std::setw(10) << run.late << " / " << run.frameUs.count() << "\n";
+    }
+    engineSchedulingPolicy() = defaultEngineSchedulingPolicy();
+    return 0;
+}
@@ -0,0 +1,56 @@
+#include "bench.h"
+#include "../../engine.hpp"
+#include "../../bot_difficulty.hpp"
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+// Plays the bot against itself from the start position at each menu level
+// and reports what one move costs: nodes searched and search time, read
+// back from EngineMetrics where the game records them too.
+static bool playLevel(const std::wstring& path, const BotDifficulty& difficulty, int plies) {
+    ChessEngine engine;
+    if (!engine.ConnectToEngine(path)) return false;
+    engine.setDifficulty(difficulty.level);
+
+    std::string moves;
+    for (int ply = 0; ply < plies; ++ply) {
+        unsigned id = engine.startSearch(moves, difficulty.limits());
+        std::string best, ponder;
+        while (!engine.pollSearch(id, best, ponder)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        if (best.empty()) break;
+        moves += (moves.empty() ? "" : " ") + best;
+    }
+    engine.CloseConnection();
+    return true;
+}
+
+int benchLevels(int argc, char** argv) {
+    std::string narrow = argc >= 1 ? argv[0] : "mock_engine";
+    std::wstring path(narrow.begin(), narrow.end());
+    int plies = argc >= 2 ? std::atoi(argv[1]) : 20;
+    if (plies <= 0) plies = 20;
+
+    const int LEVELS[] = { 0, 10, 20 };
+    std::cout << "levels: " << plies << " plies of self-play per level\n";
+    std::cout << "  level    elo    budget   nodes p50   nodes p99   search ms p50\n";
+    const EngineMetrics& metrics = EngineMetrics::instance();
+    for (int level : LEVELS) {
+        BotDifficulty difficulty = botDifficulty(level);
+        if (!playLevel(path, difficulty, plies)) {
+            std::cerr << "levels: could not start the engine\n";
+            return 1;
+        }
+        uint64_t nodes50 = 0, nodes99 = 0, us50 = 0, us99 = 0, count = 0;
+        metrics.summary(level, METRIC_SEARCH_NODES, nodes50, nodes99, count);
+        metrics.summary(level, METRIC_SEARCH_US, us50, us99, count);
+        std::cout << "  " << std::setw(5) << level << std::setw(7) << (difficulty.elo ? std::to_string(difficulty.elo) : "-")
+            << std::setw(10) << difficulty.nodes << std::setw(12) << nodes50 << std::setw(12) << nodes99
+            << std::fixed << std::setprecision(1) << std::setw(16) << us50 / 1000.0 << "\n";
+    }
+    return 0;
+}
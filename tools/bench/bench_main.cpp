@@ -0,0 +1,36 @@
+#include "bench.h"
+#include <cstring>
+#include <iostream>
+
+struct BenchEntry {
+    const char* name;
+    const char* help;
+    int (*run)(int argc, char** argv);
+};
+
+static const BenchEntry BENCHMARKS[] = {
+    { "uci-parser", "[seconds]  parse synthetic info/bestmove lines", benchUciParser },
+    { "reactor", "[engine] [seconds] [rate]  drain many engines: reader threads vs epoll", benchReactor },
+    { "frames", "[engine] [seconds] [busy threads]  frame times under a busy engine, scheduling policy off/on", benchFrames },
+    { "levels", "[engine] [plies]  nodes and search time per move at each difficulty level", benchLevels },
+    { "movegen", "[seconds]  legal moves generated, drops validated and game ends checked per second", benchMovegen },
+    { "attacks", "[seconds]  slider attack lookups: layout ray walk vs magic vs pext", benchAttacks },
+    { "analysis", "[engine] [seconds] [lines]  MultiPV analysis polled like a frame loop, every snapshot checked", benchAnalysis },
+    { "reaper", "[engine] [rate] [plugin]  engines closed with a full line queue are still shut down", benchReaper },
+};
+
+int main(int argc, char** argv) {
+    if (argc >= 2) {
+        for (const BenchEntry& bench : BENCHMARKS) {
+            if (std::strcmp(argv[1], bench.name) == 0) {
+                return bench.run(argc - 2, argv + 2);
+            }
+        }
+    }
+
+    std::cerr << "usage: bench <name> [args]\n";
+    for (const BenchEntry& bench : BENCHMARKS) {
+        std::cerr << "  " << bench.name << " " << bench.help << "\n";
+    }
+    return 1;
+}
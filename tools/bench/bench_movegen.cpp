@@ -0,0 +1,92 @@
+#include "bench.h"
+#include "../../chess_position.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Openings, middlegames and endgames: a few well-known test positions and
+// seeded random walks from each, so every move type shows up.
+static std::vector<ChessPosition> makePositions() {
+    const char* const FENS[] = {
+        START_FEN,
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    };
+    std::vector<ChessPosition> positions;
+    std::mt19937 rng(20240601);
+    for (const char* fen : FENS) {
+        for (int walk = 0; walk < 40; ++walk) {
+            ChessPosition position;
+            position.setFen(fen);
+            positions.push_back(position);
+            for (int ply = 0; ply < 30; ++ply) {
+                MoveList moves;
+                position.generateLegalMoves(moves);
+                if (moves.count == 0) break;
+                position.play(moves.moves[rng() % moves.count]);
+                positions.push_back(position);
+            }
+        }
+    }
+    return positions;
+}
+
+int benchMovegen(int argc, char** argv) {
+    double seconds = argc >= 1 ? std::atof(argv[0]) : 2.0;
+    if (seconds <= 0) seconds = 2.0;
+
+    std::vector<ChessPosition> positions = makePositions();
+    MoveList moves;
+    uint64_t generated = 0;
+    uint64_t passes = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    double elapsed = 0;
+    while (elapsed < seconds / 2) {
+        for (const ChessPosition& position : positions) {
+            position.generateLegalMoves(moves);
+            generated += moves.count;
+        }
+        ++passes;
+        if ((passes & 15) == 0) elapsed = secondsSince(start);
+    }
+    elapsed = secondsSince(start);
+    doNotOptimize(generated);
+    std::cout << "movegen: " << positions.size() << " positions, " << generated << " legal moves in " << elapsed << " s\n"
+        << "  " << static_cast<uint64_t>(generated / elapsed) << " moves/s, "
+        << static_cast<uint64_t>(passes * positions.size() / elapsed) << " positions/s\n";
+
+    // What a drop in the game costs: one isLegal per candidate move.
+    std::vector<std::pair<size_t, UciMove>> drops;
+    for (size_t i = 0; i < positions.size(); ++i) {
+        positions[i].generateLegalMoves(moves);
+        for (UciMove move : moves) drops.emplace_back(i, move);
+    }
+    uint64_t legal = 0, checks = 0;
+    start = std::chrono::steady_clock::now();
+    elapsed = 0;
+    while (elapsed < seconds / 4) {
+        for (const auto& drop : drops) legal += positions[drop.first].isLegal(drop.second);
+        checks += drops.size();
+        elapsed = secondsSince(start);
+    }
+    doNotOptimize(legal);
+    std::cout << "  isLegal: " << static_cast<uint64_t>(checks / elapsed) << " checks/s, "
+        << elapsed * 1e6 / checks << " us each\n";
+
+    // What the game pays after every ply to learn whether it is over.
+    uint64_t ended = 0, calls = 0;
+    start = std::chrono::steady_clock::now();
+    elapsed = 0;
+    while (elapsed < seconds / 4) {
+        for (const ChessPosition& position : positions) ended += position.gameEnd() != GameEnd::None;
+        calls += positions.size();
+        elapsed = secondsSince(start);
+    }
+    doNotOptimize(ended);
+    std::cout << "  gameEnd: " << elapsed * 1e9 / calls << " ns each\n";
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include "bench.h"
+#include "../../engine_backend.hpp"
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Runs N mock engines in "go infinite" with a fixed info rate and drains all
+// of their queues from one consumer, comparing a reader thread per engine
+// against the shared EngineReactor.
+struct ReaderRun {
+    double linesPerSecond = 0;
+    double wakeupsPerSecond = 0;
+};
+
+static uint64_t readerWakeups(bool shared) {
+#ifdef ENGINE_REACTOR_AVAILABLE
+    if (shared) return EngineReactor::instance().wakeups();
+#else
+    (void)shared;
+#endif
+    return PipeBackend::threadWakeups().load();
+}
+
+static bool runEngines(const std::wstring& path, int engines, bool shared, int rate, double seconds, ReaderRun& run) {
+    std::vector<std::unique_ptr<UciLineQueue>> queues;
+    std::vector<std::unique_ptr<PipeBackend>> backends;
+    std::string setup = "uci\nsetoption name Info Rate value " + std::to_string(rate) +
+        "\nposition startpos\ngo infinite\n";
+
+    for (int i = 0; i < engines; ++i) {
+        queues.emplace_back(new UciLineQueue());
+        queues.back()->reset();
+        backends.emplace_back(new PipeBackend(shared));
+        if (!backends.back()->start(path, *queues.back())) {
+            std::cerr << "reactor: could not start the engine\n";
+            return false;
+        }
+        backends.back()->write(setup.data(), setup.size());
+    }
+
+    std::string line;
+    auto drainAll = [&]() {
+        uint64_t count = 0;
+        for (auto& queue : queues) {
+            while (queue->tryPop(line)) ++count;
+        }
+        return count;
+    };
+
+    // Let the handshakes finish before measuring.
+    auto warmup = std::chrono::steady_clock::now();
+    while (secondsSince(warmup) < 0.3) {
+        drainAll();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    uint64_t lines = 0;
+    uint64_t wakeupsBefore = readerWakeups(shared);
+    auto start = std::chrono::steady_clock::now();
+    while (secondsSince(start) < seconds) {
+        uint64_t drained = drainAll();
+        lines += drained;
+        if (drained == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    double elapsed = secondsSince(start);
+    uint64_t wakeups = readerWakeups(shared) - wakeupsBefore;
+
+    const char stop[] = "stop\n";
+    for (auto& backend : backends) backend->write(stop, sizeof(stop) - 1);
+    for (auto& backend : backends) backend->shutdown(1000);
+
+    run.linesPerSecond = lines / elapsed;
+    run.wakeupsPerSecond = wakeups / elapsed;
+    return true;
+}
+
+int benchReactor(int argc, char** argv) {
+    std::string narrow = argc >= 1 ? argv[0] : "mock_engine";
+    std::wstring path(narrow.begin(), narrow.end());
+    double seconds = argc >= 2 ? std::atof(argv[1]) : 2.0;
+    int rate = argc >= 3 ? std::atoi(argv[2]) : 2000;
+    if (seconds <= 0) seconds = 2.0;
+
+    const int COUNTS[] = { 1, 4, 16, 64 };
+    std::cout << "reactor: " << rate << " info lines/s per engine, " << seconds << " s per run\n"
+        << "  engines  reader        lines/s   wakeups/s  lines/wakeup\n";
+    for (int engines : COUNTS) {
+        for (int mode = 0; mode < 2; ++mode) {
+            bool shared = mode == 1;
+#ifndef ENGINE_REACTOR_AVAILABLE
+            if (shared) continue;
+#endif
+            ReaderRun run;
+            if (!runEngines(path, engines, shared, rate, seconds, run)) return 1;
+            std::cout << "  " << std::setw(7) << engines << "  " << std::left << std::setw(10)
+                << (shared ? "reactor" : "threads") << std::right
+                << std::setw(12) << static_cast<uint64_t>(run.linesPerSecond)
+                << std::setw(12) << static_cast<uint64_t>(run.wakeupsPerSecond)
+                << std::setw(14) << std::fixed << std::setprecision(1)
+                << (run.wakeupsPerSecond > 0 ? run.linesPerSecond / run.wakeupsPerSecond : 0.0) << "\n";
+            std::cout.unsetf(std::ios::fixed);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include "bench.h"
+#include "../../engine.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+// Hands EngineReaper engines whose line queue is full and that nobody reads
+// any more, as when the UI drops an engine in the middle of a flood of
+// analysis output, and checks each one is gone well within the timeout.
+// A reader parked on the full queue used to keep the reaper from ever
+// finishing, which hung every later shutdown and process exit.
+//
+// Given an engine plugin as well, floods its queue the same way and then
+// stops the search from the consumer's thread, which used to deadlock on a
+// plugin callback waiting for room: stop, a readyok round trip and the
+// shutdown all have to finish.
+static bool reapFullQueue(const std::wstring& path, bool shared, int rate, double& reapMs, std::string& problem) {
+    std::unique_ptr<UciLineQueue> lines(new UciLineQueue());
+    lines->reset();
+    std::unique_ptr<EngineBackend> backend(new PipeBackend(shared));
+    if (!backend->start(path, *lines)) {
+        problem = "could not start the engine";
+        return false;
+    }
+    std::string setup = "uci\nsetoption name Info Rate value " + std::to_string(rate) +
+        "\nposition startpos\ngo infinite\n";
+    backend->write(setup.data(), setup.size());
+
+    // Full is where the reader stops: parked on the queue with a thread of
+    // its own, paused short of it with the reactor.
+    auto start = std::chrono::steady_clock::now();
+    auto lastChange = start;
+    size_t freeSlots = lines->freeSlots();
+    while (freeSlots > 256 || secondsSince(lastChange) < 0.1) {
+        if (secondsSince(start) > 10) {
+            problem = "the queue never filled up";
+            backend->shutdown(0);
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        size_t now = lines->freeSlots();
+        if (now != freeSlots) lastChange = std::chrono::steady_clock::now();
+        freeSlots = now;
+    }
+
+    auto handover = std::chrono::steady_clock::now();
+    EngineReaper::instance().reap(std::move(backend), std::move(lines), 200);
+    if (!EngineReaper::instance().drain(5000)) {
+        problem = "the engine was not reaped within 5 s";
+        return false;
+    }
+    reapMs = secondsSince(handover) * 1000;
+    return true;
+}
+
+static bool floodPlugin(const std::wstring& path, int rate, double& totalMs, std::string& problem) {
+    // Leaked if it hangs, since the thread still using it cannot be stopped.
+    ChessEngine* engine = new ChessEngine();
+    if (!engine->ConnectToEngine(path)) {
+        problem = "could not load the plugin";
+        delete engine;
+        return false;
+    }
+    if (!engine->hasOption("Info Rate")) {
+        problem = "the plugin has no Info Rate option";
+        delete engine;
+        return false;
+    }
+    engine->setOption("Info Rate", rate);
+    unsigned id = engine->startSearch("", SearchLimits::infinite());
+    std::this_thread::sleep_for(std::chrono::milliseconds(100 + 2 * 1024 * 1000 / rate));
+
+    std::atomic<int> step{ 0 };
+    bool ready = false;
+    auto start = std::chrono::steady_clock::now();
+    std::thread consumer([&] {
+        engine->stopSearch(id);
+        step = 1;
+        ready = engine->resetForNewGame(2000);
+        step = 2;
+        engine->CloseConnection();
+        step = 3;
+    });
+    while (step < 3 && secondsSince(start) < 5) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    if (step < 3) {
+        const char* const STUCK[] = { "stop", "the readyok round trip", "closing" };
+        problem = std::string(STUCK[step]) + " did not return within 5 s";
+        consumer.detach();
+        return false;
+    }
+    consumer.join();
+    delete engine;
+    if (!ready) {
+        problem = "no readyok after the flood";
+        return false;
+    }
+    if (!EngineReaper::instance().drain(5000)) {
+        problem = "the plugin was not reaped within 5 s";
+        return false;
+    }
+    totalMs = secondsSince(start) * 1000;
+    return true;
+}
+
+int benchReaper(int argc, char** argv) {
+    std::string narrow = argc >= 1 ? argv[0] : "mock_engine";
+    std::wstring path(narrow.begin(), narrow.end());
+    int rate = argc >= 2 ? std::atoi(argv[1]) : 20000;
+    if (rate <= 0) rate = 20000;
+    std::string plugin = argc >= 3 ? argv[2] : "";
+
+    std::cout << "reaper: engines closed with a full line queue, " << rate << " info lines/s\n";
+    bool passed = true;
+    for (int mode = 0; mode < 2; ++mode) {
+        bool shared = mode == 1;
+#ifndef ENGINE_REACTOR_AVAILABLE
+        if (shared) continue;
+#endif
+        double reapMs = 0;
+        std::string problem;
+        bool reaped = reapFullQueue(path, shared, rate, reapMs, problem);
+        std::cout << "  " << (shared ? "reactor" : "threads") << ": ";
+        if (reaped) std::cout << "reaped in " << reapMs << " ms\n";
+        else std::cout << "FAILED: " << problem << "\n";
+        passed = passed && reaped;
+    }
+    if (!plugin.empty()) {
+        double totalMs = 0;
+        std::string problem;
+        bool done = floodPlugin(std::wstring(plugin.begin(), plugin.end()), rate, totalMs, problem);
+        std::cout << "  plugin: ";
+        if (done) std::cout << "stopped, answered and reaped in " << totalMs << " ms\n";
+        else std::cout << "FAILED: " << problem << "\n";
+        passed = passed && done;
+    }
+    return passed ? 0 : 1;
+}
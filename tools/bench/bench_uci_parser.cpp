@@ -0,0 +1,71 @@
+#include "bench.h"
+#include "../../uci_parser.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Lines shaped like Stockfish output at moderate depth: long pv, all the
+// counters, plus the occasional currmove/string/bestmove line.
+static std::vector<std::string> makeCorpus() {
+    const char* pv = " pv e2e4 e7e5 g1f3 b8c6 f1b5 a7a6 b5a4 g8f6 e1g1 f8e7 f1e1 b7b5 a4b3 d7d6 c2c3 e8g8 h2h3 c6a5 b3c2 c7c5";
+    std::vector<std::string> corpus;
+    for (int depth = 1; depth <= 30; ++depth) {
+        std::string d = std::to_string(depth);
+        corpus.push_back("info depth " + d + " seldepth " + std::to_string(depth + 8) +
+            " multipv 1 score cp " + std::to_string(20 + depth % 7) + " nodes " + std::to_string(depth * 123457) +
+            " nps 1534000 hashfull " + std::to_string(depth * 30) + " tbhits 0 time " + std::to_string(depth * 80) + pv);
+        corpus.push_back("info depth " + d + " seldepth " + std::to_string(depth + 6) +
+            " multipv 2 score mate -" + std::to_string(depth % 5 + 1) + " upperbound nodes 99123 nps 1400000 time 65" + pv);
+        corpus.push_back("info depth " + d + " currmove g1f3 currmovenumber " + std::to_string(depth % 20 + 1));
+    }
+    corpus.push_back("info string NNUE evaluation using nn-b1a57edbea57.nnue enabled");
+    corpus.push_back("bestmove e2e4 ponder e7e5");
+    corpus.push_back("bestmove e7e8q");
+    return corpus;
+}
+
+int benchUciParser(int argc, char** argv) {
+    double seconds = argc >= 1 ? std::atof(argv[0]) : 2.0;
+    if (seconds <= 0) seconds = 2.0;
+
+    std::vector<std::string> corpus = makeCorpus();
+    size_t corpusBytes = 0;
+    for (const std::string& line : corpus) corpusBytes += line.size() + 1;
+
+    UciInfo info;
+    UciBestMove best;
+    uint64_t checksum = 0;
+    uint64_t lines = 0;
+    uint64_t passes = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    double elapsed = 0;
+    while (elapsed < seconds) {
+        for (const std::string& line : corpus) {
+            std::string_view view(line);
+            switch (classifyUciLine(view)) {
+            case UciLineType::Info:
+                parseUciInfo(view, info);
+                checksum += info.depth + info.nodes + info.pvLength + info.score.value;
+                break;
+            case UciLineType::BestMove:
+                parseUciBestMove(view, best);
+                checksum += best.move + best.ponder;
+                break;
+            default:
+                break;
+            }
+        }
+        lines += corpus.size();
+        ++passes;
+        if ((passes & 255) == 0) elapsed = secondsSince(start);
+    }
+    elapsed = secondsSince(start);
+    doNotOptimize(checksum);
+
+    std::cout << "uci-parser: " << lines << " lines in " << elapsed << " s\n"
+        << "  " << static_cast<uint64_t>(lines / elapsed) << " lines/s, "
+        << (passes * corpusBytes / elapsed) / (1024.0 * 1024.0) << " MiB/s\n";
+    return 0;
+}
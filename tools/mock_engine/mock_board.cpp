@@ -0,0 +1,248 @@
+#include "mock_board.h"
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+namespace {
+    const int KNIGHT_STEPS[8][2] = { {1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2} };
+    const int KING_STEPS[8][2] = { {1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1} };
+    const int BISHOP_DIRS[4][2] = { {1, 1}, {1, -1}, {-1, 1}, {-1, -1} };
+    const int ROOK_DIRS[4][2] = { {1, 0}, {-1, 0}, {0, 1}, {0, -1} };
+
+    bool onBoard(int file, int rank) {
+        return file >= 0 && file < 8 && rank >= 0 && rank < 8;
+    }
+
+    std::string squareName(int square) {
+        return std::string(1, static_cast<char>('a' + square % 8)) + static_cast<char>('1' + square / 8);
+    }
+
+    int parseSquare(const std::string& text, size_t at) {
+        if (text.size() < at + 2) return -1;
+        int file = text[at] - 'a', rank = text[at + 1] - '1';
+        return onBoard(file, rank) ? rank * 8 + file : -1;
+    }
+}
+
+MockBoard::MockBoard() {
+    setStartPosition();
+}
+
+void MockBoard::setStartPosition() {
+    setFen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+}
+
+bool MockBoard::setFen(const std::string& fen) {
+    std::istringstream in(fen);
+    std::string placement, side, rights, ep;
+    if (!(in >> placement >> side)) return false;
+    in >> rights >> ep;
+
+    for (int& square : squares) square = 0;
+    int rank = 7, file = 0;
+    for (char c : placement) {
+        if (c == '/') {
+            --rank;
+            file = 0;
+        }
+        else if (c >= '1' && c <= '8') {
+            file += c - '0';
+        }
+        else {
+            const char* codes = "pnbrqk";
+            const char* found = strchr(codes, tolower(static_cast<unsigned char>(c)));
+            if (!found || !onBoard(file, rank)) return false;
+            int piece = static_cast<int>(found - codes) + 1;
+            squares[rank * 8 + file] = isupper(static_cast<unsigned char>(c)) ? piece : -piece;
+            ++file;
+        }
+    }
+
+    whiteToMove = side != "b";
+    castling = 0;
+    for (char c : rights) {
+        if (c == 'K') castling |= 1;
+        if (c == 'Q') castling |= 2;
+        if (c == 'k') castling |= 4;
+        if (c == 'q') castling |= 8;
+    }
+    enPassant = ep == "-" ? -1 : parseSquare(ep, 0);
+    return true;
+}
+
+bool MockBoard::play(const std::string& move) {
+    int from = parseSquare(move, 0), to = parseSquare(move, 2);
+    if (from < 0 || to < 0) return false;
+
+    int piece = squares[from];
+    int type = abs(piece);
+    int sign = piece > 0 ? 1 : -1;
+
+    if (type == 1 && to == enPassant) squares[to - 8 * sign] = 0;
+    if (type == 6 && abs(to - from) == 2) {
+        int rookFrom = to > from ? from + 3 : from - 4;
+        int rookTo = to > from ? from + 1 : from - 1;
+        squares[rookTo] = squares[rookFrom];
+        squares[rookFrom] = 0;
+    }
+
+    enPassant = (type == 1 && abs(to - from) == 16) ? (from + to) / 2 : -1;
+
+    squares[to] = piece;
+    squares[from] = 0;
+    if (move.size() == 5) {
+        const char* codes = "nbrq";
+        const char* found = strchr(codes, move[4]);
+        if (found && move[4] != '\0') squares[to] = sign * static_cast<int>(found - codes + 2);
+    }
+
+    // Any move from or onto a king or rook home square loses those rights.
+    const int RIGHTS_LOST[6][2] = { {4, 1 | 2}, {7, 1}, {0, 2}, {60, 4 | 8}, {63, 4}, {56, 8} };
+    for (const auto& lost : RIGHTS_LOST) {
+        if (from == lost[0] || to == lost[0]) castling &= ~lost[1];
+    }
+
+    whiteToMove = !whiteToMove;
+    return true;
+}
+
+bool MockBoard::attacked(int square, bool byWhite) const {
+    int sign = byWhite ? 1 : -1;
+    int file = square % 8, rank = square / 8;
+
+    int pawnRank = rank - sign;
+    for (int df = -1; df <= 1; df += 2) {
+        if (onBoard(file + df, pawnRank) && squares[pawnRank * 8 + file + df] == sign * 1) return true;
+    }
+    for (const auto& step : KNIGHT_STEPS) {
+        int f = file + step[0], r = rank + step[1];
+        if (onBoard(f, r) && squares[r * 8 + f] == sign * 2) return true;
+    }
+    for (const auto& step : KING_STEPS) {
+        int f = file + step[0], r = rank + step[1];
+        if (onBoard(f, r) && squares[r * 8 + f] == sign * 6) return true;
+    }
+    for (int slider = 0; slider < 2; ++slider) {
+        const int (*dirs)[2] = slider == 0 ? BISHOP_DIRS : ROOK_DIRS;
+        int mover = slider == 0 ? 3 : 4;
+        for (int d = 0; d < 4; ++d) {
+            int f = file + dirs[d][0], r = rank + dirs[d][1];
+            while (onBoard(f, r)) {
+                int piece = squares[r * 8 + f];
+                if (piece != 0) {
+                    if (piece == sign * mover || piece == sign * 5) return true;
+                    break;
+                }
+                f += dirs[d][0];
+                r += dirs[d][1];
+            }
+        }
+    }
+    return false;
+}
+
+bool MockBoard::inCheck(bool white) const {
+    int king = white ? 6 : -6;
+    for (int square = 0; square < 64; ++square) {
+        if (squares[square] == king) return attacked(square, !white);
+    }
+    return false;
+}
+
+void MockBoard::addPawnMoves(int from, std::vector<std::string>& moves) const {
+    int sign = whiteToMove ? 1 : -1;
+    int file = from % 8, rank = from / 8;
+    int next = rank + sign;
+    if (next < 0 || next > 7) return;
+
+    auto add = [&](int to) {
+        std::string move = squareName(from) + squareName(to);
+        if (to / 8 == 0 || to / 8 == 7) {
+            for (char promo : { 'q', 'r', 'b', 'n' }) moves.push_back(move + promo);
+        }
+        else {
+            moves.push_back(move);
+        }
+    };
+
+    int forward = next * 8 + file;
+    if (squares[forward] == 0) {
+        add(forward);
+        int startRank = whiteToMove ? 1 : 6;
+        int twoForward = forward + 8 * sign;
+        if (rank == startRank && squares[twoForward] == 0) add(twoForward);
+    }
+    for (int df = -1; df <= 1; df += 2) {
+        if (!onBoard(file + df, next)) continue;
+        int to = next * 8 + file + df;
+        if (squares[to] * sign < 0 || to == enPassant) add(to);
+    }
+}
+
+void MockBoard::pseudoLegalMoves(std::vector<std::string>& moves) const {
+    int sign = whiteToMove ? 1 : -1;
+    for (int from = 0; from < 64; ++from) {
+        int piece = squares[from] * sign;
+        if (piece <= 0) continue;
+        int file = from % 8, rank = from / 8;
+
+        auto tryStep = [&](int f, int r) {
+            if (!onBoard(f, r)) return false;
+            int target = squares[r * 8 + f] * sign;
+            if (target > 0) return false;
+            moves.push_back(squareName(from) + squareName(r * 8 + f));
+            return target == 0;
+        };
+
+        switch (piece) {
+        case 1:
+            addPawnMoves(from, moves);
+            break;
+        case 2:
+            for (const auto& step : KNIGHT_STEPS) tryStep(file + step[0], rank + step[1]);
+            break;
+        case 6:
+            for (const auto& step : KING_STEPS) tryStep(file + step[0], rank + step[1]);
+            break;
+        default:
+            for (int slider = 0; slider < 2; ++slider) {
+                if ((slider == 0 && piece == 4) || (slider == 1 && piece == 3)) continue;
+                const int (*dirs)[2] = slider == 0 ? BISHOP_DIRS : ROOK_DIRS;
+                for (int d = 0; d < 4; ++d) {
+                    int f = file + dirs[d][0], r = rank + dirs[d][1];
+                    while (tryStep(f, r)) {
+                        f += dirs[d][0];
+                        r += dirs[d][1];
+                    }
+                }
+            }
+            break;
+        }
+    }
+
+    // Castling: rights, empty path, and the king never passes through check.
+    int home = whiteToMove ? 4 : 60;
+    int kingSide = whiteToMove ? 1 : 4, queenSide = whiteToMove ? 2 : 8;
+    if (squares[home] == sign * 6 && !attacked(home, !whiteToMove)) {
+        if ((castling & kingSide) && squares[home + 1] == 0 && squares[home + 2] == 0 &&
+            squares[home + 3] == sign * 4 && !attacked(home + 1, !whiteToMove)) {
+            moves.push_back(squareName(home) + squareName(home + 2));
+        }
+        if ((castling & queenSide) && squares[home - 1] == 0 && squares[home - 2] == 0 &&
+            squares[home - 3] == 0 && squares[home - 4] == sign * 4 && !attacked(home - 1, !whiteToMove)) {
+            moves.push_back(squareName(home) + squareName(home - 2));
+        }
+    }
+}
+
+std::vector<std::string> MockBoard::legalMoves() const {
+    std::vector<std::string> candidates, legal;
+    pseudoLegalMoves(candidates);
+    for (const std::string& move : candidates) {
+        MockBoard after = *this;
+        after.play(move);
+        if (!after.inCheck(whiteToMove)) legal.push_back(move);
+    }
+    return legal;
+}
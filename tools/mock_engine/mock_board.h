@@ -0,0 +1,31 @@
+// mock_board.h
+#pragma once
+#include <string>
+#include <vector>
+
+// Just enough chess for the mock engine to answer with legal moves: a
+// mailbox board using the game's piece codes (1 pawn .. 6 king, positive for
+// white), square 0 = a1 .. 63 = h8.
+class MockBoard {
+private:
+    int squares[64];
+    bool whiteToMove = true;
+    int castling = 0;       // 1 = K, 2 = Q, 4 = k, 8 = q
+    int enPassant = -1;     // square a pawn may capture onto
+
+    bool attacked(int square, bool byWhite) const;
+    bool inCheck(bool white) const;
+    void addPawnMoves(int from, std::vector<std::string>& moves) const;
+    void pseudoLegalMoves(std::vector<std::string>& moves) const;
+
+public:
+    MockBoard();
+
+    void setStartPosition();
+    bool setFen(const std::string& fen);
+    // Plays a UCI move without checking it; false if it is not even well-formed.
+    bool play(const std::string& move);
+
+    std::vector<std::string> legalMoves() const;
+    bool sideToMoveInCheck() const { return inCheck(whiteToMove); }
+};
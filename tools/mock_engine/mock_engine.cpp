@@ -0,0 +1,334 @@
+// Stand-in UCI engine for running the game, the pipe reader and the
+// benchmarks without Stockfish. Everything it does is reproducible: moves
+// come from a script or from a seeded choice among the legal moves, after a
+// fixed delay or once a "go nodes" budget is spent (5000 nodes per info
+// line), with an optional flood of synthetic info lines. With MultiPV set,
+// every info tick reports that many lines, each led by a different legal
+// move, the chosen one first. --busy keeps
+// that many threads spinning while it searches, to load the CPU like a real
+// engine would.
+//
+//   mock_engine [--delay ms] [--seed n] [--script "e7e5 g8f6 ..."]
+//               [--info-rate lines/s] [--flood lines] [--busy threads] [--name text]
+#include "mock_board.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct MockOptions {
+    int delayMs = 100;          // think time per go; infinite/ponder wait for stop/ponderhit
+    uint32_t seed = 1;
+    std::vector<std::string> script; // replies in order, then random legal moves
+    int infoRate = 20;          // info lines per second while thinking, 0 for none
+    int flood = 0;              // info lines written at once when a search starts
+    int busyThreads = 0;        // threads burning CPU while a search runs
+    int multiPv = 1;            // lines per info tick, set over UCI only
+    std::string name = "MockEngine";
+};
+
+namespace {
+    std::mutex outputMutex;
+
+    void send(const std::string& line) {
+        std::lock_guard<std::mutex> lock(outputMutex);
+        fwrite(line.data(), 1, line.size(), stdout);
+        fputc('\n', stdout);
+        fflush(stdout);
+    }
+
+    uint32_t hashText(const std::string& text) {
+        uint32_t hash = 2166136261u;
+        for (unsigned char c : text) hash = (hash ^ c) * 16777619u;
+        return hash;
+    }
+
+    bool parseOptions(int argc, char** argv, MockOptions& options) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (i + 1 >= argc) return false;
+            std::string value = argv[++i];
+
+            if (arg == "--delay") options.delayMs = atoi(value.c_str());
+            else if (arg == "--seed") options.seed = static_cast<uint32_t>(strtoul(value.c_str(), nullptr, 10));
+            else if (arg == "--info-rate") options.infoRate = atoi(value.c_str());
+            else if (arg == "--flood") options.flood = atoi(value.c_str());
+            else if (arg == "--busy") options.busyThreads = atoi(value.c_str());
+            else if (arg == "--name") options.name = value;
+            else if (arg == "--script") {
+                std::istringstream moves(value);
+                std::string move;
+                while (moves >> move) options.script.push_back(move);
+            }
+            else return false;
+        }
+        return true;
+    }
+}
+
+class MockEngine {
+private:
+    MockOptions options;
+    MockBoard board;
+    std::string positionKey;  // position command, seeds the move choice
+    size_t scriptIndex = 0;
+
+    std::thread searchThread;
+    std::mutex searchMutex;
+    std::condition_variable searchCv;
+    bool stopRequested = false;
+    bool ponderHit = false;
+
+    std::string chooseMove(std::string& ponder) {
+        std::vector<std::string> moves = board.legalMoves();
+        ponder.clear();
+        if (moves.empty()) return "";
+
+        if (scriptIndex < options.script.size()) return options.script[scriptIndex++];
+
+        std::mt19937 rng(options.seed ^ hashText(positionKey));
+        std::string move = moves[rng() % moves.size()];
+
+        MockBoard after = board;
+        after.play(move);
+        std::vector<std::string> replies = after.legalMoves();
+        if (!replies.empty()) ponder = replies[rng() % replies.size()];
+        return move;
+    }
+
+    static std::string infoLine(int depth, uint64_t nodes, int64_t elapsedMs, const std::string& pv, int multipv = 1) {
+        uint64_t nps = elapsedMs > 0 ? nodes * 1000 / elapsedMs : nodes;
+        return "info depth " + std::to_string(depth) + " seldepth " + std::to_string(depth + 2) +
+            " multipv " + std::to_string(multipv) + " score cp " + std::to_string(depth % 7 * 3 - 9 - 5 * (multipv - 1)) +
+            " nodes " + std::to_string(nodes) +
+            " nps " + std::to_string(nps) + " time " + std::to_string(elapsedMs) + " pv " + pv;
+    }
+
+    void search(bool waitForStop, bool ponder, uint64_t nodeLimit) {
+        auto start = std::chrono::steady_clock::now();
+        std::string ponderMove;
+        std::string move = chooseMove(ponderMove);
+        std::string pv = move.empty() ? "" : move + (ponderMove.empty() ? "" : " " + ponderMove);
+        std::vector<std::string> pvs;
+        if (!move.empty()) pvs.push_back(pv);
+        for (const std::string& other : board.legalMoves()) {
+            if (static_cast<int>(pvs.size()) >= options.multiPv) break;
+            if (other != move) pvs.push_back(other);
+        }
+
+        if (move.empty()) {
+            send(board.sideToMoveInCheck() ? "info depth 0 score mate 0" : "info depth 0 score cp 0");
+        }
+        for (int i = 0; i < options.flood; ++i) {
+            send(infoLine(1 + i % 30, 1000ull * (i + 1), 0, pv));
+        }
+
+        // Rates above 1000/s are met by writing several lines per 1 ms tick.
+        auto interval = std::chrono::milliseconds(options.infoRate > 0 ? std::max(1, 1000 / options.infoRate) : 0);
+        uint64_t emitted = 0;
+        auto deadline = start + std::chrono::milliseconds(options.delayMs);
+        uint64_t nodes = 0;
+        int depth = 0;
+
+        std::atomic<bool> spinning{ true };
+        std::vector<std::thread> burners;
+        for (int i = 0; i < options.busyThreads; ++i) {
+            burners.emplace_back([&spinning] {
+                volatile uint64_t work = 0;
+                while (spinning.load(std::memory_order_relaxed)) work = work * 6364136223846793005ull + 1;
+            });
+        }
+
+        std::unique_lock<std::mutex> lock(searchMutex);
+        while (!stopRequested) {
+            // A ponder search becomes a normal one at ponderhit and thinks from there.
+            if (ponder && ponderHit) {
+                ponder = false;
+                waitForStop = false;
+                deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(options.delayMs);
+            }
+            auto now = std::chrono::steady_clock::now();
+            bool waiting = ponder || waitForStop;
+            if (!waiting && (now >= deadline || (nodeLimit > 0 && nodes >= nodeLimit))) break;
+
+            auto wakeAt = waiting ? now + std::chrono::hours(1) : deadline;
+            if (options.infoRate > 0 && !move.empty()) wakeAt = std::min(wakeAt, now + interval);
+            searchCv.wait_until(lock, wakeAt);
+
+            if (options.infoRate > 0 && !move.empty() && !stopRequested) {
+                int64_t elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - start).count();
+                uint64_t due = std::max<uint64_t>(emitted + 1, static_cast<uint64_t>(elapsed) * options.infoRate / 1000);
+                lock.unlock();
+                for (; emitted < due; ++emitted) {
+                    nodes += 5000;
+                    if (nodeLimit > 0 && nodes > nodeLimit) nodes = nodeLimit;
+                    ++depth;
+                    for (size_t line = 0; line < pvs.size(); ++line) {
+                        send(infoLine(depth % 100 + 1, nodes, elapsed, pvs[line], static_cast<int>(line) + 1));
+                    }
+                }
+                lock.lock();
+            }
+        }
+
+        lock.unlock();
+        spinning = false;
+        for (std::thread& burner : burners) burner.join();
+
+        send(move.empty() ? "bestmove (none)" :
+            "bestmove " + move + (ponderMove.empty() ? "" : " ponder " + ponderMove));
+    }
+
+    void stopSearch() {
+        if (!searchThread.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(searchMutex);
+            stopRequested = true;
+        }
+        searchCv.notify_all();
+        searchThread.join();
+    }
+
+    void setPosition(std::istringstream& args) {
+        std::string token;
+        args >> token;
+        if (token == "startpos") {
+            board.setStartPosition();
+            args >> token;
+        }
+        else if (token == "fen") {
+            std::string fen, field;
+            while (args >> field && field != "moves") fen += (fen.empty() ? "" : " ") + field;
+            board.setFen(fen);
+            token = field;
+        }
+        if (token == "moves") {
+            std::string move;
+            while (args >> move) board.play(move);
+        }
+    }
+
+    // The command-line knobs can also be turned over UCI, so a driver that
+    // only knows the engine's path can still configure it.
+    void setOption(const std::string& line) {
+        size_t nameAt = line.find(" name ");
+        size_t valueAt = line.find(" value ");
+        if (nameAt == std::string::npos || valueAt == std::string::npos || valueAt < nameAt) return;
+        std::string name = line.substr(nameAt + 6, valueAt - nameAt - 6);
+        int value = atoi(line.c_str() + valueAt + 7);
+
+        stopSearch();
+        if (name == "Move Delay") options.delayMs = value;
+        else if (name == "Info Rate") options.infoRate = value;
+        else if (name == "Flood") options.flood = value;
+        else if (name == "Busy Threads") options.busyThreads = value;
+        else if (name == "MultiPV") options.multiPv = std::max(1, value);
+    }
+
+    void go(std::istringstream& args) {
+        stopSearch();
+        bool infinite = false, ponder = false;
+        uint64_t nodes = 0;
+        std::string token;
+        while (args >> token) {
+            if (token == "infinite") infinite = true;
+            if (token == "ponder") ponder = true;
+            if (token == "nodes") args >> nodes;
+        }
+        stopRequested = false;
+        ponderHit = false;
+        searchThread = std::thread(&MockEngine::search, this, infinite, ponder, nodes);
+    }
+
+public:
+    explicit MockEngine(const MockOptions& options) : options(options) {}
+
+    ~MockEngine() {
+        stopSearch();
+    }
+
+    // Returns false on "quit".
+    bool handle(const std::string& line) {
+        std::istringstream args(line);
+        std::string command;
+        if (!(args >> command)) return true;
+
+        if (command == "uci") {
+            send("id name " + options.name);
+            send("id author vibe-chess");
+            send("option name Threads type spin default 1 min 1 max 1024");
+            send("option name Hash type spin default 16 min 1 max 33554432");
+            send("option name MultiPV type spin default 1 min 1 max 500");
+            send("option name Ponder type check default false");
+            send("option name Skill Level type spin default 20 min 0 max 20");
+            send("option name UCI_LimitStrength type check default false");
+            send("option name UCI_Elo type spin default 1320 min 1320 max 3190");
+            send("option name Move Delay type spin default " + std::to_string(options.delayMs) + " min 0 max 600000");
+            send("option name Info Rate type spin default " + std::to_string(options.infoRate) + " min 0 max 1000000");
+            send("option name Flood type spin default " + std::to_string(options.flood) + " min 0 max 100000000");
+            send("option name Busy Threads type spin default " + std::to_string(options.busyThreads) + " min 0 max 256");
+            send("uciok");
+        }
+        else if (command == "isready") {
+            send("readyok");
+        }
+        else if (command == "ucinewgame") {
+            stopSearch();
+            board.setStartPosition();
+            scriptIndex = 0;
+        }
+        else if (command == "position") {
+            positionKey = line;
+            setPosition(args);
+        }
+        else if (command == "go") {
+            go(args);
+        }
+        else if (command == "stop") {
+            stopSearch();
+        }
+        else if (command == "ponderhit") {
+            {
+                std::lock_guard<std::mutex> lock(searchMutex);
+                ponderHit = true;
+            }
+            searchCv.notify_all();
+        }
+        else if (command == "setoption") {
+            setOption(line);
+        }
+        else if (command == "quit") {
+            stopSearch();
+            return false;
+        }
+        return true; // anything unknown is accepted silently
+    }
+};
+
+int main(int argc, char** argv) {
+    MockOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "usage: mock_engine [--delay ms] [--seed n] [--script \"moves\"]"
+            " [--info-rate lines/s] [--flood lines] [--name text]\n";
+        return 1;
+    }
+
+    MockEngine engine(options);
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!engine.handle(line)) break;
+    }
+    return 0;
+}
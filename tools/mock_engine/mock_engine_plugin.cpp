@@ -0,0 +1,210 @@
+// In-process build of the mock engine (see engine_plugin.h): the same
+// seeded legal-move replies as mock_engine, loaded with dlopen/LoadLibrary
+// instead of spawned. Think time comes from the "Move Delay" option, and
+// "Info Rate" floods info lines while thinking, as mock_engine's does.
+#include "mock_board.h"
+#include "../../engine_plugin.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    const char OPTIONS[] =
+        "option name Threads type spin default 1 min 1 max 1024\n"
+        "option name Hash type spin default 16 min 1 max 33554432\n"
+        "option name MultiPV type spin default 1 min 1 max 500\n"
+        "option name Ponder type check default false\n"
+        "option name Skill Level type spin default 20 min 0 max 20\n"
+        "option name Move Delay type spin default 100 min 0 max 60000\n"
+        "option name Info Rate type spin default 0 min 0 max 1000000\n";
+
+    uint32_t hashText(const std::string& text) {
+        uint32_t hash = 2166136261u;
+        for (unsigned char c : text) hash = (hash ^ c) * 16777619u;
+        return hash;
+    }
+
+    struct PluginEngine {
+        VcInfoCallback onInfo;
+        VcBestMoveCallback onBestMove;
+        void* user;
+
+        MockBoard board;
+        std::string positionKey;
+        int delayMs = 100;
+        int infoRate = 0; // info lines per second while thinking
+
+        std::thread searchThread;
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool stopRequested = false;
+        bool ponderHit = false;
+
+        void search(VcSearchLimits limits) {
+            std::vector<std::string> moves = board.legalMoves();
+            std::string move, ponder;
+            if (!moves.empty()) {
+                std::mt19937 rng(hashText(positionKey));
+                move = moves[rng() % moves.size()];
+                MockBoard after = board;
+                after.play(move);
+                std::vector<std::string> replies = after.legalMoves();
+                if (!replies.empty()) ponder = replies[rng() % replies.size()];
+            }
+
+            VcEngineInfo info = {};
+            info.multipv = 1;
+            if (move.empty()) {
+                info.score_kind = board.sideToMoveInCheck() ? VC_SCORE_MATE : VC_SCORE_CP;
+                onInfo(user, &info);
+            }
+            std::string pv = move.empty() ? "" : move + (ponder.empty() ? "" : " " + ponder);
+
+            bool waiting = limits.infinite || limits.ponder;
+            int thinkMs = limits.movetime_ms > 0 && limits.movetime_ms < delayMs ? limits.movetime_ms : delayMs;
+            auto start = std::chrono::steady_clock::now();
+            auto deadline = start + std::chrono::milliseconds(thinkMs);
+            // Rates above 1000/s are met by reporting several lines per 1 ms tick.
+            auto interval = std::chrono::milliseconds(infoRate > 0 ? std::max(1, 1000 / infoRate) : 0);
+            uint64_t emitted = 0;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                while (!stopRequested) {
+                    if (limits.ponder && ponderHit) {
+                        limits.ponder = 0;
+                        waiting = limits.infinite != 0;
+                        deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(thinkMs);
+                    }
+                    auto now = std::chrono::steady_clock::now();
+                    if (!waiting && now >= deadline) break;
+
+                    auto wakeAt = waiting ? now + std::chrono::hours(1) : deadline;
+                    if (infoRate > 0 && !move.empty()) wakeAt = std::min(wakeAt, now + interval);
+                    cv.wait_until(lock, wakeAt);
+
+                    if (infoRate > 0 && !move.empty() && !stopRequested) {
+                        uint64_t elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            std::chrono::steady_clock::now() - start).count();
+                        uint64_t due = std::max<uint64_t>(emitted + 1, elapsed * infoRate / 1000);
+                        lock.unlock();
+                        for (; emitted < due; ++emitted) {
+                            info.depth = 1 + static_cast<int>(emitted % 30);
+                            info.score_kind = VC_SCORE_CP;
+                            info.nodes = 5000 * (emitted + 1);
+                            info.pv = pv.c_str();
+                            onInfo(user, &info);
+                        }
+                        lock.lock();
+                    }
+                }
+            }
+
+            if (!move.empty()) {
+                info.depth = 1;
+                info.score_kind = VC_SCORE_CP;
+                info.nodes = 1000;
+                info.pv = pv.c_str();
+                onInfo(user, &info);
+            }
+            onBestMove(user, move.c_str(), ponder.c_str());
+        }
+
+        void stop() {
+            if (!searchThread.joinable()) return;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopRequested = true;
+            }
+            cv.notify_all();
+            searchThread.join();
+        }
+    };
+
+    void* create(VcInfoCallback onInfo, VcBestMoveCallback onBestMove, void* user) {
+        PluginEngine* engine = new PluginEngine();
+        engine->onInfo = onInfo;
+        engine->onBestMove = onBestMove;
+        engine->user = user;
+        return engine;
+    }
+
+    void destroy(void* handle) {
+        PluginEngine* engine = static_cast<PluginEngine*>(handle);
+        engine->stop();
+        delete engine;
+    }
+
+    void setOption(void* handle, const char* name, const char* value) {
+        PluginEngine* engine = static_cast<PluginEngine*>(handle);
+        if (strcmp(name, "Move Delay") == 0) engine->delayMs = atoi(value);
+        else if (strcmp(name, "Info Rate") == 0) engine->infoRate = atoi(value);
+    }
+
+    void newGame(void* handle) {
+        PluginEngine* engine = static_cast<PluginEngine*>(handle);
+        engine->stop();
+        engine->board.setStartPosition();
+    }
+
+    void setPosition(void* handle, const char* fen, const char* moves) {
+        PluginEngine* engine = static_cast<PluginEngine*>(handle);
+        if (fen) engine->board.setFen(fen);
+        else engine->board.setStartPosition();
+        engine->positionKey = std::string(fen ? fen : "startpos") + " " + moves;
+
+        const char* at = moves;
+        while (*at) {
+            while (*at == ' ') ++at;
+            const char* end = at;
+            while (*end && *end != ' ') ++end;
+            if (end > at) engine->board.play(std::string(at, end));
+            at = end;
+        }
+    }
+
+    void search(void* handle, const VcSearchLimits* limits) {
+        PluginEngine* engine = static_cast<PluginEngine*>(handle);
+        engine->stop();
+        engine->stopRequested = false;
+        engine->ponderHit = false;
+        engine->searchThread = std::thread(&PluginEngine::search, engine, *limits);
+    }
+
+    void stop(void* handle) {
+        static_cast<PluginEngine*>(handle)->stop();
+    }
+
+    void ponderhit(void* handle) {
+        PluginEngine* engine = static_cast<PluginEngine*>(handle);
+        {
+            std::lock_guard<std::mutex> lock(engine->mutex);
+            engine->ponderHit = true;
+        }
+        engine->cv.notify_all();
+    }
+
+    const VcEngineApi API = {
+        VC_ENGINE_ABI_VERSION,
+        "MockEngine (in-process)",
+        OPTIONS,
+        create,
+        destroy,
+        setOption,
+        newGame,
+        setPosition,
+        search,
+        stop,
+        ponderhit
+    };
+}
+
+extern "C" VC_ENGINE_EXPORT const VcEngineApi* vc_engine_api(void) {
+    return &API;
+}
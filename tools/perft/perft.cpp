@@ -0,0 +1,289 @@
+// Counts the leaf nodes of the legal move tree to a fixed depth and checks
+// them against published values, which is how a move generator is proven
+// right: a single missed en passant pin or castling right changes the count.
+// Root moves are shared out to a pool of threads, subtrees already counted
+// are looked up in a shared hash table, and the rate is reported in nodes
+// per second so regressions in the rules core show up.
+//
+// With no position it runs the whole suite, after checking that malformed
+// FENs are refused, and exits 1 on any mismatch.
+//
+//   perft [--depth n] [--threads n] [--hash MB] [--divide] [name | "fen"]
+//
+// Names are those of the suite: startpos, kiwipete, endgame, promotions,
+// talkchess, midgame. --hash 0 turns the table off, which measures the bare
+// generator; with it on, the rate counts nodes the table skipped.
+#include "../../chess_position.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct PerftPosition {
+    const char* name;
+    const char* fen;
+    int depth;                  // the suite runs each position this deep
+    uint64_t expected[8];       // by depth from 1, 0 past what is known
+};
+
+// The usual positions from the Chess Programming Wiki's perft results.
+static const PerftPosition SUITE[] = {
+    { "startpos", START_FEN, 6,
+        { 20, 400, 8902, 197281, 4865609, 119060324, 3195901860ull } },
+    { "kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 5,
+        { 48, 2039, 97862, 4085603, 193690690, 8031647685ull } },
+    { "endgame", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 7,
+        { 14, 191, 2812, 43238, 674624, 11030083, 178633661, 3009794393ull } },
+    { "promotions", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 5,
+        { 6, 264, 9467, 422333, 15833292, 706045033 } },
+    { "talkchess", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 5,
+        { 44, 1486, 62379, 2103487, 89941194 } },
+    { "midgame", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 5,
+        { 46, 2079, 89890, 3894594, 164075551, 6923051137ull } },
+};
+
+// FENs setFen has to refuse, each with what is wrong with it.
+static const char* const BAD_FENS[][2] = {
+    { "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBN w KQkq - 0 1", "a rank of 7 files" },
+    { "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNRR w KQkq - 0 1", "a rank of 9 files" },
+    { "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP w KQkq - 0 1", "7 ranks" },
+    { "rnbqkbnr/pppppppp/8/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", "9 ranks" },
+    { "rnbqkbnr/pppppppp/44/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", "two digits in a row" },
+    { "4k3/8/8/8/4P3/8/3P4/4K3 w - e3 0 1", "en passant on rank 3 with white to move" },
+    { "4k3/3p4/8/4p3/8/8/8/4K3 b - e6 0 1", "en passant on rank 6 with black to move" },
+    { "4k3/8/8/3P4/8/8/8/4K3 w - e6 0 1", "en passant with no pawn in front of it" },
+    { "4k3/8/8/3PP3/8/8/8/4K3 w - e6 0 1", "en passant with a pawn of the side to move in front" },
+    { "4k3/8/4n3/3Pp3/8/8/8/4K3 w - e6 0 1", "en passant square occupied" },
+    { "4k3/4n3/8/3Pp3/8/8/8/4K3 w - e6 0 1", "en passant pawn's start square occupied" },
+    { "4k3/8/8/8/3pP3/8/4N3/4K3 b - e3 0 1", "en passant pawn's start square occupied, black to move" },
+    { "4k3/8/8/3Pp3/8/8/8/4K3 w - e9 0 1", "en passant square off the board" },
+};
+
+// FENs setFen accepts only after dropping what the position cannot have.
+static const char* const NORMALIZED_FENS[][2] = {
+    { "4k3/8/8/3Pp3/8/8/8/4K3 w - e6 0 1", "4k3/8/8/3Pp3/8/8/8/4K3 w - e6 0 1" },
+    { "4k3/8/8/4p3/8/8/8/4K3 w - e6 0 1", "4k3/8/8/4p3/8/8/8/4K3 w - - 0 1" },
+    { "4k3/8/8/8/8/8/8/R3K1R1 w KQkq - 0 1", "4k3/8/8/8/8/8/8/R3K1R1 w Q - 0 1" },
+    { "r3k2r/8/8/8/8/8/8/3K3R w KQkq - 0 1", "r3k2r/8/8/8/8/8/8/3K3R w kq - 0 1" },
+};
+
+static bool checkFens() {
+    bool passed = true;
+    for (const auto& bad : BAD_FENS) {
+        ChessPosition position;
+        if (position.setFen(bad[0])) {
+            std::cout << "FAIL fen accepted with " << bad[1] << ": " << bad[0] << "\n";
+            passed = false;
+        }
+    }
+    for (const auto& normalized : NORMALIZED_FENS) {
+        ChessPosition position;
+        std::string got = position.setFen(normalized[0]) ? position.fen() : "(refused)";
+        if (got != normalized[1]) {
+            std::cout << "FAIL fen " << normalized[0] << " read as " << got << ", expected " << normalized[1] << "\n";
+            passed = false;
+        }
+    }
+    std::cout << (passed ? "OK  " : "FAIL") << " fen parsing: " << std::size(BAD_FENS) << " refused, "
+        << std::size(NORMALIZED_FENS) << " normalized\n";
+    return passed;
+}
+
+// Subtree counts by position key and depth, shared by all threads without
+// locks. Each slot stores the count and the count XOR the key, so a slot
+// torn by two threads writing at once fails the check and reads as a miss.
+class PerftTable {
+private:
+    struct Slot {
+        std::atomic<uint64_t> check{ 0 };
+        std::atomic<uint64_t> nodes{ 0 };
+    };
+    std::unique_ptr<Slot[]> slots;
+    uint64_t mask = 0;
+
+    // The depth goes into the key so one position can hold several counts.
+    static uint64_t slotKey(uint64_t key, int depth) {
+        return key ^ (depth * 0x9E3779B97F4A7C15ull);
+    }
+
+public:
+    explicit PerftTable(size_t megabytes) {
+        if (megabytes == 0) return;
+        size_t count = 1;
+        while (count * 2 * sizeof(Slot) <= megabytes * 1024 * 1024) count *= 2;
+        slots.reset(new Slot[count]);
+        mask = count - 1;
+    }
+
+    bool enabled() const { return slots != nullptr; }
+
+    bool probe(uint64_t key, int depth, uint64_t& nodes) const {
+        uint64_t full = slotKey(key, depth);
+        const Slot& slot = slots[full & mask];
+        uint64_t stored = slot.nodes.load(std::memory_order_relaxed);
+        if ((slot.check.load(std::memory_order_relaxed) ^ stored) != full) return false;
+        nodes = stored;
+        return true;
+    }
+
+    void store(uint64_t key, int depth, uint64_t nodes) {
+        uint64_t full = slotKey(key, depth);
+        Slot& slot = slots[full & mask];
+        slot.check.store(full ^ nodes, std::memory_order_relaxed);
+        slot.nodes.store(nodes, std::memory_order_relaxed);
+    }
+};
+
+// The last ply is counted, not played.
+static uint64_t perft(const ChessPosition& position, int depth, PerftTable& table) {
+    MoveList moves;
+    position.generateLegalMoves(moves);
+    if (depth <= 1) return depth == 1 ? moves.count : 1;
+
+    uint64_t key = 0, nodes = 0;
+    if (table.enabled()) {
+        key = position.key();
+        if (table.probe(key, depth, nodes)) return nodes;
+    }
+    for (UciMove move : moves) {
+        ChessPosition child = position;
+        child.play(move);
+        nodes += perft(child, depth - 1, table);
+    }
+    if (table.enabled()) table.store(key, depth, nodes);
+    return nodes;
+}
+
+// Each thread takes the next unclaimed root move until none are left, so a
+// few deep subtrees do not leave the other threads idle at the end.
+static std::vector<uint64_t> perftRootMoves(const ChessPosition& root, const MoveList& moves,
+    int depth, int threads, PerftTable& table) {
+    std::vector<uint64_t> counts(moves.count);
+    std::atomic<int> nextMove{ 0 };
+    auto worker = [&]() {
+        for (int i = nextMove++; i < moves.count; i = nextMove++) {
+            ChessPosition child = root;
+            child.play(moves.moves[i]);
+            counts[i] = perft(child, depth - 1, table);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int i = 1; i < std::min(threads, moves.count); ++i) pool.emplace_back(worker);
+    worker();
+    for (std::thread& thread : pool) thread.join();
+    return counts;
+}
+
+struct PerftResult {
+    uint64_t nodes = 0;
+    double seconds = 0;
+};
+
+static PerftResult runPerft(const ChessPosition& root, int depth, int threads, PerftTable& table, bool divide) {
+    auto start = std::chrono::steady_clock::now();
+    PerftResult result;
+    MoveList moves;
+    root.generateLegalMoves(moves);
+
+    if (depth <= 1) {
+        result.nodes = depth == 1 ? moves.count : 1;
+        if (divide && depth == 1) {
+            for (UciMove move : moves) std::cout << uciMoveToString(move) << ": 1\n";
+        }
+    }
+    else {
+        std::vector<uint64_t> counts = perftRootMoves(root, moves, depth, threads, table);
+        for (uint64_t count : counts) result.nodes += count;
+
+        if (divide) {
+            std::vector<std::pair<std::string, uint64_t>> lines;
+            for (int i = 0; i < moves.count; ++i) lines.emplace_back(uciMoveToString(moves.moves[i]), counts[i]);
+            std::sort(lines.begin(), lines.end());
+            for (const auto& line : lines) std::cout << line.first << ": " << line.second << "\n";
+        }
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (divide) std::cout << "\nmoves: " << moves.count << "\n";
+    return result;
+}
+
+static void report(const char* name, int depth, const PerftResult& result, uint64_t expected) {
+    const char* verdict = expected == 0 ? "    " : result.nodes == expected ? "OK  " : "FAIL";
+    std::cout << verdict << " " << name << " depth " << depth << ": " << result.nodes << " nodes";
+    if (expected != 0 && result.nodes != expected) std::cout << " (expected " << expected << ")";
+    std::cout << " in " << result.seconds << " s, "
+        << static_cast<uint64_t>(result.nodes / std::max(result.seconds, 1e-9)) << " nodes/s\n";
+}
+
+int main(int argc, char** argv) {
+    int depth = 0;
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    size_t hashMegabytes = 64;
+    bool divide = false;
+    const char* target = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--depth") == 0 && hasValue) depth = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--threads") == 0 && hasValue) threads = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--hash") == 0 && hasValue) hashMegabytes = std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--divide") == 0) divide = true;
+        else if (argv[i][0] != '-' && !target) target = argv[i];
+        else {
+            std::cerr << "usage: perft [--depth n] [--threads n] [--hash MB] [--divide] [name | \"fen\"]\n";
+            return 1;
+        }
+    }
+
+    std::cout << threads << " threads, " << (hashMegabytes ? std::to_string(hashMegabytes) + " MB hash" : "no hash") << "\n";
+
+    // One position, named or given as a FEN; checked when its count is known.
+    if (target) {
+        const PerftPosition* known = nullptr;
+        for (const PerftPosition& position : SUITE) {
+            if (std::strcmp(target, position.name) == 0 || std::strcmp(target, position.fen) == 0) known = &position;
+        }
+        ChessPosition root;
+        if (!root.setFen(known ? known->fen : target)) {
+            std::cerr << "not a suite position or a valid FEN: " << target << "\n";
+            return 1;
+        }
+        if (depth <= 0) depth = 5;
+        uint64_t expected = known && depth <= 8 ? known->expected[depth - 1] : 0;
+
+        PerftTable table(hashMegabytes);
+        PerftResult result = runPerft(root, depth, threads, table, divide);
+        report(known ? known->name : "fen", depth, result, expected);
+        return expected != 0 && result.nodes != expected ? 1 : 0;
+    }
+
+    // The suite, each position at its own depth unless --depth overrides it.
+    bool passed = checkFens();
+    uint64_t totalNodes = 0;
+    double totalSeconds = 0;
+    for (const PerftPosition& position : SUITE) {
+        ChessPosition root;
+        root.setFen(position.fen);
+        int runDepth = depth > 0 ? std::min(depth, 8) : position.depth;
+
+        PerftTable table(hashMegabytes);
+        PerftResult result = runPerft(root, runDepth, threads, table, divide);
+        uint64_t expected = position.expected[runDepth - 1];
+        report(position.name, runDepth, result, expected);
+        passed = passed && (expected == 0 || result.nodes == expected);
+        totalNodes += result.nodes;
+        totalSeconds += result.seconds;
+    }
+    std::cout << (passed ? "all passed" : "FAILED") << ", " << totalNodes << " nodes in " << totalSeconds << " s, "
+        << static_cast<uint64_t>(totalNodes / std::max(totalSeconds, 1e-9)) << " nodes/s\n";
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,73 @@
+// uci_command_batch.hpp
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Newline-terminated UCI commands waiting to go out in a single write.
+// clear() keeps the capacity, so a long-lived batch stops allocating once
+// it has seen its largest flush.
+class UciCommandBatch {
+private:
+    std::string buffer;
+    size_t commandCount = 0;
+
+    static void appendNumber(std::string& out, int64_t value) {
+        char digits[24];
+        char* end = digits + sizeof(digits);
+        char* at = end;
+        uint64_t magnitude = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+        do {
+            *--at = static_cast<char>('0' + magnitude % 10);
+            magnitude /= 10;
+        } while (magnitude);
+        if (value < 0) *--at = '-';
+        out.append(at, end);
+    }
+
+public:
+    UciCommandBatch() {
+        buffer.reserve(256);
+    }
+
+    // Each encoder returns the bytes it added, newline included.
+    size_t add(std::string_view command) {
+        buffer.append(command.data(), command.size());
+        buffer += '\n';
+        ++commandCount;
+        return command.size() + 1;
+    }
+
+    size_t setOption(std::string_view name, int64_t value) {
+        size_t before = buffer.size();
+        buffer.append("setoption name ");
+        buffer.append(name.data(), name.size());
+        buffer.append(" value ");
+        appendNumber(buffer, value);
+        buffer += '\n';
+        ++commandCount;
+        return buffer.size() - before;
+    }
+
+    size_t setOption(std::string_view name, std::string_view value) {
+        size_t before = buffer.size();
+        buffer.append("setoption name ");
+        buffer.append(name.data(), name.size());
+        buffer.append(" value ");
+        buffer.append(value.data(), value.size());
+        buffer += '\n';
+        ++commandCount;
+        return buffer.size() - before;
+    }
+
+    bool empty() const { return buffer.empty(); }
+    const char* data() const { return buffer.data(); }
+    size_t size() const { return buffer.size(); }
+    size_t commands() const { return commandCount; }
+
+    void clear() {
+        buffer.clear();
+        commandCount = 0;
+    }
+};
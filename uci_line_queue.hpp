@@ -0,0 +1,166 @@
+// uci_line_queue.hpp
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Single-producer/single-consumer ring of complete UCI lines.
+// The engine reader thread feeds raw stdout chunks in and they are split on
+// '\n' exactly once; consumers pull whole lines out in O(1). Slot strings are
+// swapped with the consumer's buffer instead of copied, so after warm-up no
+// line costs an allocation.
+class UciLineQueue {
+private:
+    static const size_t CAPACITY = 1024; // must be a power of two
+    static const size_t MASK = CAPACITY - 1;
+
+    std::vector<std::string> slots;
+    alignas(64) std::atomic<size_t> head{ 0 }; // next slot to pop (consumer)
+    alignas(64) std::atomic<size_t> tail{ 0 }; // next slot to fill (producer)
+    alignas(64) std::atomic<bool> closed{ true };
+    std::atomic<bool> abandoned{ false }; // no consumer any more; lines are dropped
+    std::atomic<bool> consumerWaiting{ false };
+    std::atomic<bool> producerWaiting{ false };
+    std::mutex waitMutex;
+    std::condition_variable waitCv;
+    std::string partial; // producer-only: bytes after the last '\n'
+
+    void wake(std::atomic<bool>& waiting) {
+        if (waiting.load()) {
+            std::lock_guard<std::mutex> lock(waitMutex);
+            waitCv.notify_all();
+        }
+    }
+
+    void pushLine(const char* data, size_t size) {
+        if (size > 0 && data[size - 1] == '\r') --size;
+        if (size == 0) return;
+
+        if (abandoned.load() || closed.load()) return;
+
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == CAPACITY) {
+            // Nobody is draining; hold the engine back instead of dropping a bestmove.
+            std::unique_lock<std::mutex> lock(waitMutex);
+            producerWaiting.store(true);
+            waitCv.wait(lock, [&] {
+                return t - head.load(std::memory_order_acquire) < CAPACITY || abandoned.load();
+            });
+            producerWaiting.store(false);
+            if (abandoned.load()) return;
+        }
+
+        slots[t & MASK].assign(data, size);
+        tail.store(t + 1);
+        wake(consumerWaiting);
+    }
+
+public:
+    UciLineQueue() : slots(CAPACITY) {}
+
+    // Producer side. Must not be called while a producer is running.
+    void reset() {
+        head.store(0);
+        tail.store(0);
+        partial.clear();
+        abandoned.store(false);
+        closed.store(false);
+    }
+
+    void feed(const char* data, size_t size) {
+        const char* end = data + size;
+        while (data < end) {
+            const char* nl = static_cast<const char*>(memchr(data, '\n', end - data));
+            if (!nl) {
+                partial.append(data, end - data);
+                return;
+            }
+
+            if (partial.empty()) {
+                pushLine(data, nl - data);
+            }
+            else {
+                partial.append(data, nl - data);
+                pushLine(partial.data(), partial.size());
+                partial.clear();
+            }
+            data = nl + 1;
+        }
+    }
+
+    // Pushes one complete line if more than `reserve` slots are free and
+    // returns false otherwise, so it never waits. For producers that must
+    // not block, like the callbacks of an engine running in-process.
+    bool tryPushLine(const char* data, size_t size, size_t reserve = 0) {
+        if (freeSlots() <= reserve) return false;
+        pushLine(data, size);
+        return true;
+    }
+
+    // Lines that can still be pushed without blocking the producer.
+    size_t freeSlots() const {
+        return CAPACITY - (tail.load(std::memory_order_relaxed) - head.load(std::memory_order_acquire));
+    }
+
+    // Never waits: an unterminated last line that does not fit is dropped,
+    // since close() may run on the consumer's own thread.
+    void close() {
+        if (!partial.empty() && freeSlots() > 0) {
+            pushLine(partial.data(), partial.size());
+        }
+        partial.clear();
+        closed.store(true);
+        std::lock_guard<std::mutex> lock(waitMutex);
+        waitCv.notify_all();
+    }
+
+    // Consumer side. Gives the queue up for good: a producer waiting for
+    // room is released and everything pushed from now on is dropped, so an
+    // engine whose output nobody reads any more can still be shut down.
+    void abandon() {
+        abandoned.store(true);
+        std::lock_guard<std::mutex> lock(waitMutex);
+        waitCv.notify_all();
+    }
+
+    bool tryPop(std::string& line) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+
+        line.swap(slots[h & MASK]);
+        head.store(h + 1);
+        wake(producerWaiting);
+        return true;
+    }
+
+    bool popUntil(std::string& line, std::chrono::steady_clock::time_point deadline) {
+        while (true) {
+            if (tryPop(line)) return true;
+            if (closed.load()) return tryPop(line);
+
+            std::unique_lock<std::mutex> lock(waitMutex);
+            consumerWaiting.store(true);
+            bool ready = waitCv.wait_until(lock, deadline, [&] {
+                return head.load(std::memory_order_relaxed) != tail.load(std::memory_order_acquire) ||
+                    closed.load();
+            });
+            consumerWaiting.store(false);
+            if (!ready) return false;
+        }
+    }
+
+    // Drops everything queued so far, e.g. output of a search nobody waits for.
+    void clear() {
+        size_t t = tail.load(std::memory_order_acquire);
+        head.store(t);
+        wake(producerWaiting);
+    }
+
+    bool isClosed() const {
+        return closed.load();
+    }
+};
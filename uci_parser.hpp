@@ -0,0 +1,329 @@
+// uci_parser.hpp
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Zero-copy parser for engine output. Lines are read in place through
+// std::string_view and decoded into fixed-size structs, so parsing a line
+// never allocates.
+
+// Compact move: from | to << 6 | promotion << 12, squares a1 = 0 .. h8 = 63.
+// a1a1 is never a move, so 0 doubles as "none" (and as UCI's "0000").
+typedef uint16_t UciMove;
+const UciMove UCI_MOVE_NONE = 0;
+
+enum UciPromotion {
+    UCI_PROMO_NONE = 0,
+    UCI_PROMO_KNIGHT = 1,
+    UCI_PROMO_BISHOP = 2,
+    UCI_PROMO_ROOK = 3,
+    UCI_PROMO_QUEEN = 4
+};
+
+inline int uciMoveFrom(UciMove move) { return move & 63; }
+inline int uciMoveTo(UciMove move) { return (move >> 6) & 63; }
+inline int uciMovePromotion(UciMove move) { return move >> 12; }
+
+inline UciMove makeUciMove(int from, int to, int promotion = UCI_PROMO_NONE) {
+    return static_cast<UciMove>(from | (to << 6) | (promotion << 12));
+}
+
+// Returns UCI_MOVE_NONE for anything that is not a coordinate move.
+inline UciMove parseUciMove(std::string_view text) {
+    if (text.size() != 4 && text.size() != 5) return UCI_MOVE_NONE;
+    unsigned fromFile = text[0] - 'a', fromRank = text[1] - '1';
+    unsigned toFile = text[2] - 'a', toRank = text[3] - '1';
+    if (fromFile > 7 || fromRank > 7 || toFile > 7 || toRank > 7) return UCI_MOVE_NONE;
+
+    int promotion = UCI_PROMO_NONE;
+    if (text.size() == 5) {
+        switch (text[4]) {
+        case 'n': promotion = UCI_PROMO_KNIGHT; break;
+        case 'b': promotion = UCI_PROMO_BISHOP; break;
+        case 'r': promotion = UCI_PROMO_ROOK; break;
+        case 'q': promotion = UCI_PROMO_QUEEN; break;
+        default: return UCI_MOVE_NONE;
+        }
+    }
+    return makeUciMove(fromRank * 8 + fromFile, toRank * 8 + toFile, promotion);
+}
+
+// Writes 4 or 5 characters (no terminator) and returns how many.
+inline size_t formatUciMove(UciMove move, char* out) {
+    int from = uciMoveFrom(move), to = uciMoveTo(move);
+    out[0] = static_cast<char>('a' + (from & 7));
+    out[1] = static_cast<char>('1' + (from >> 3));
+    out[2] = static_cast<char>('a' + (to & 7));
+    out[3] = static_cast<char>('1' + (to >> 3));
+    if (uciMovePromotion(move) == UCI_PROMO_NONE) return 4;
+    out[4] = " nbrq"[uciMovePromotion(move)];
+    return 5;
+}
+
+inline std::string uciMoveToString(UciMove move) {
+    if (move == UCI_MOVE_NONE) return "";
+    char buf[5];
+    return std::string(buf, formatUciMove(move, buf));
+}
+
+enum class UciLineType { Info, BestMove, ReadyOk, UciOk, Id, Option, Other };
+
+const int UCI_MAX_PV = 64;
+
+struct UciScore {
+    enum Kind { None, Centipawns, Mate };
+    Kind kind = None;
+    int value = 0;
+    bool lowerbound = false;
+    bool upperbound = false;
+};
+
+struct UciInfo {
+    int depth = 0;
+    int seldepth = 0;
+    int multipv = 1;
+    UciScore score;
+    uint64_t nodes = 0;
+    uint64_t nps = 0;
+    int hashfull = -1;
+    uint64_t tbhits = 0;
+    int64_t timeMs = -1;
+    UciMove currmove = UCI_MOVE_NONE;
+    int pvLength = 0;
+    UciMove pv[UCI_MAX_PV];
+    std::string_view text; // payload of "info string", points into the parsed line
+};
+
+struct UciBestMove {
+    UciMove move = UCI_MOVE_NONE; // none for "bestmove (none)"
+    UciMove ponder = UCI_MOVE_NONE;
+};
+
+// One "option name ... type ..." line of the uci handshake. Views point into
+// the parsed line.
+struct UciOption {
+    std::string_view name;          // may contain spaces, e.g. "Skill Level"
+    std::string_view type;          // check, spin, combo, button or string
+    std::string_view defaultValue;
+    int64_t min = 0;
+    int64_t max = 0;
+    bool hasRange = false;          // spin options only
+};
+
+// Splits a line on spaces/tabs without copying.
+class UciTokenizer {
+private:
+    std::string_view line;
+    size_t pos = 0;
+
+    static bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+
+public:
+    explicit UciTokenizer(std::string_view line) : line(line) {}
+
+    bool next(std::string_view& token) {
+        while (pos < line.size() && isSpace(line[pos])) ++pos;
+        if (pos == line.size()) return false;
+        size_t start = pos;
+        while (pos < line.size() && !isSpace(line[pos])) ++pos;
+        token = line.substr(start, pos - start);
+        return true;
+    }
+
+    // Everything after the current token, leading whitespace trimmed.
+    std::string_view rest() {
+        while (pos < line.size() && isSpace(line[pos])) ++pos;
+        std::string_view tail = line.substr(pos);
+        pos = line.size();
+        return tail;
+    }
+};
+
+inline bool parseUciUnsigned(std::string_view text, uint64_t& value) {
+    if (text.empty() || text.size() > 19) return false;
+    uint64_t result = 0;
+    for (char c : text) {
+        unsigned digit = static_cast<unsigned char>(c) - '0';
+        if (digit > 9) return false;
+        result = result * 10 + digit;
+    }
+    value = result;
+    return true;
+}
+
+inline bool parseUciInt(std::string_view text, int64_t& value) {
+    bool negative = !text.empty() && text[0] == '-';
+    uint64_t magnitude;
+    if (!parseUciUnsigned(negative ? text.substr(1) : text, magnitude)) return false;
+    value = negative ? -static_cast<int64_t>(magnitude) : static_cast<int64_t>(magnitude);
+    return true;
+}
+
+inline UciLineType classifyUciLine(std::string_view line) {
+    UciTokenizer tokens(line);
+    std::string_view first;
+    if (!tokens.next(first)) return UciLineType::Other;
+    if (first == "info") return UciLineType::Info;
+    if (first == "bestmove") return UciLineType::BestMove;
+    if (first == "readyok") return UciLineType::ReadyOk;
+    if (first == "uciok") return UciLineType::UciOk;
+    if (first == "id") return UciLineType::Id;
+    if (first == "option") return UciLineType::Option;
+    return UciLineType::Other;
+}
+
+// Fills `info` from an "info ..." line; fields the line does not mention keep
+// their defaults. Unknown keywords are skipped.
+inline bool parseUciInfo(std::string_view line, UciInfo& info) {
+    UciTokenizer tokens(line);
+    std::string_view token;
+    if (!tokens.next(token) || token != "info") return false;
+
+    info.depth = 0;
+    info.seldepth = 0;
+    info.multipv = 1;
+    info.score = UciScore();
+    info.nodes = 0;
+    info.nps = 0;
+    info.hashfull = -1;
+    info.tbhits = 0;
+    info.timeMs = -1;
+    info.currmove = UCI_MOVE_NONE;
+    info.pvLength = 0;
+    info.text = std::string_view();
+
+    std::string_view value;
+    uint64_t number;
+    int64_t signedNumber;
+    bool haveToken = false; // token already holds the next keyword
+    while (haveToken || tokens.next(token)) {
+        haveToken = false;
+
+        if (token == "lowerbound") {
+            info.score.lowerbound = true;
+            continue;
+        }
+        if (token == "upperbound") {
+            info.score.upperbound = true;
+            continue;
+        }
+        if (token == "string") {
+            info.text = tokens.rest();
+            break;
+        }
+        if (token == "pv") {
+            while (tokens.next(value)) {
+                UciMove move = parseUciMove(value);
+                if (move == UCI_MOVE_NONE) {
+                    token = value;
+                    haveToken = true;
+                    break;
+                }
+                if (info.pvLength < UCI_MAX_PV) info.pv[info.pvLength++] = move;
+            }
+            continue;
+        }
+        if (!tokens.next(value)) break;
+
+        if (token == "depth") {
+            if (parseUciUnsigned(value, number)) info.depth = static_cast<int>(number);
+        }
+        else if (token == "seldepth") {
+            if (parseUciUnsigned(value, number)) info.seldepth = static_cast<int>(number);
+        }
+        else if (token == "multipv") {
+            if (parseUciUnsigned(value, number)) info.multipv = static_cast<int>(number);
+        }
+        else if (token == "score") {
+            std::string_view amount;
+            if (!tokens.next(amount) || !parseUciInt(amount, signedNumber)) continue;
+            info.score.kind = value == "mate" ? UciScore::Mate : UciScore::Centipawns;
+            info.score.value = static_cast<int>(signedNumber);
+        }
+        else if (token == "nodes") {
+            parseUciUnsigned(value, info.nodes);
+        }
+        else if (token == "nps") {
+            parseUciUnsigned(value, info.nps);
+        }
+        else if (token == "hashfull") {
+            if (parseUciUnsigned(value, number)) info.hashfull = static_cast<int>(number);
+        }
+        else if (token == "tbhits") {
+            parseUciUnsigned(value, info.tbhits);
+        }
+        else if (token == "time") {
+            if (parseUciInt(value, signedNumber)) info.timeMs = signedNumber;
+        }
+        else if (token == "currmove") {
+            info.currmove = parseUciMove(value);
+        }
+        else if (token == "wdl") {
+            tokens.next(value);
+            tokens.next(value);
+        }
+    }
+    return true;
+}
+
+inline bool parseUciOption(std::string_view line, UciOption& option) {
+    UciTokenizer tokens(line);
+    std::string_view token;
+    if (!tokens.next(token) || token != "option") return false;
+    if (!tokens.next(token) || token != "name") return false;
+
+    option = UciOption();
+    const char* nameStart = nullptr;
+    const char* nameEnd = nullptr;
+    while (tokens.next(token) && token != "type") {
+        if (!nameStart) nameStart = token.data();
+        nameEnd = token.data() + token.size();
+    }
+    if (!nameStart || token != "type" || !tokens.next(option.type)) return false;
+    option.name = std::string_view(nameStart, nameEnd - nameStart);
+
+    // Values run up to the next keyword; a string default may hold spaces.
+    std::string_view keyword;
+    bool haveKeyword = tokens.next(keyword);
+    while (haveKeyword) {
+        const char* valueStart = nullptr;
+        const char* valueEnd = nullptr;
+        haveKeyword = false;
+        while (tokens.next(token)) {
+            if (token == "default" || token == "min" || token == "max" || token == "var") {
+                haveKeyword = true;
+                break;
+            }
+            if (!valueStart) valueStart = token.data();
+            valueEnd = token.data() + token.size();
+        }
+        std::string_view value = valueStart ? std::string_view(valueStart, valueEnd - valueStart) : std::string_view();
+
+        int64_t number;
+        if (keyword == "default") option.defaultValue = value;
+        else if (keyword == "min" && parseUciInt(value, number)) option.min = number;
+        else if (keyword == "max" && parseUciInt(value, number)) {
+            option.max = number;
+            option.hasRange = true;
+        }
+        if (haveKeyword) keyword = token;
+    }
+    return true;
+}
+
+inline bool parseUciBestMove(std::string_view line, UciBestMove& best) {
+    UciTokenizer tokens(line);
+    std::string_view token;
+    if (!tokens.next(token) || token != "bestmove") return false;
+
+    best = UciBestMove();
+    if (!tokens.next(token)) return false;
+    best.move = parseUciMove(token);
+
+    if (tokens.next(token) && token == "ponder" && tokens.next(token)) {
+        best.ponder = parseUciMove(token);
+    }
+    return true;
+}
@@ -0,0 +1,35 @@
+// zobrist.hpp
+#pragma once
+#include <cstdint>
+
+// Random keys for hashing a position: one per piece on each square, one for
+// black to move, one per castling-rights set and one per en passant file.
+// A position's key is the XOR of the keys of everything in it. Generated at
+// compile time with splitmix64 from a fixed seed, so keys (and any table
+// indexed by them) are the same on every run and build.
+struct ZobristKeys {
+    uint64_t pieces[2][7][64] = {};  // [colour][type][square], type 0 unused
+    uint64_t blackToMove = 0;
+    uint64_t castling[16] = {};      // by the CastlingRight bits, [0] is 0
+    uint64_t enPassant[8] = {};
+
+    constexpr ZobristKeys() {
+        uint64_t state = 0x5EEDC0DE2024ull;
+        auto next = [&state]() {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        };
+        for (int color = 0; color < 2; ++color) {
+            for (int type = 1; type < 7; ++type) {
+                for (int square = 0; square < 64; ++square) pieces[color][type][square] = next();
+            }
+        }
+        blackToMove = next();
+        for (int rights = 1; rights < 16; ++rights) castling[rights] = next();
+        for (int file = 0; file < 8; ++file) enPassant[file] = next();
+    }
+};
+
+inline constexpr ZobristKeys ZOBRIST{};